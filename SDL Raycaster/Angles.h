@@ -0,0 +1,20 @@
+#ifndef ANGLES_H
+#define ANGLES_H
+
+#include "SDL.h"	// For M_PI
+#include <cmath>
+
+// The game works in degrees, and the trigonometric functions in radians
+
+// Convert an angle from degrees to radians (needed for use with trigonometric functions)
+inline float radians(float degrees)
+{
+	return static_cast<float>(degrees * (M_PI / 180.0f));
+}
+
+inline float degrees(float radians)
+{
+	return static_cast<float>(radians * (180.0f / M_PI));
+}
+
+#endif
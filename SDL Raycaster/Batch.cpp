@@ -0,0 +1,179 @@
+#include "Batch.h"
+#include "FrameFile.h"
+#include "Renderer.h"
+#include "SDL.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// State shared by the worker threads. Everything in here is only touched with the lock held
+	struct BatchQueue
+	{
+		std::mutex lock{};
+		std::ifstream jobs{};
+		int nextFrame{ 0 };
+		int lineNumber{ 0 };
+		int framesFailed{ 0 };		// Frames which couldn't be written
+
+		// The packed file has its own lock, so a worker writing to it doesn't hold up the others getting their next pose
+		std::mutex packedLock{};
+		std::ofstream packed{};		// Only open when writing a packed file
+	};
+
+	// Read the next pose from the job file. Returns false once the file runs out
+	bool nextPose(BatchQueue& queue, const RenderContext& context, Camera& camera, int& frame)
+	{
+		std::lock_guard<std::mutex> guard{ queue.lock };
+
+		std::string line{};
+		while (std::getline(queue.jobs, line))
+		{
+			queue.lineNumber++;
+
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream values{ line };
+			float pitch{};
+			if (!(values >> camera.x >> camera.y >> camera.theta >> pitch >> camera.height))
+			{
+				std::cout << "Skipping bad pose on line " << queue.lineNumber << " of the job file\n";
+				continue;
+			}
+
+			// Pitch moves the projection plane's center up and down from the middle of the screen, the same way the arrow keys do
+			camera.projectionPlaneCenter = std::min(std::max(context.height / 2 + static_cast<int>(pitch), 0), context.height);
+			camera.height = std::min(std::max(camera.height, 1), context.gridSize - 1);
+
+			frame = queue.nextFrame++;
+			return true;
+		}
+
+		return false;
+	}
+
+	void renderJobs(BatchQueue& queue, const RenderContext& sharedContext, ColumnRenderer renderColumns, const BatchSettings& settings, int& framesRendered)
+	{
+		// Each worker has its own copy of the context with its own buffers. The map and textures are shared and only read
+		std::vector<uint32_t> screen(sharedContext.width * sharedContext.height);
+		ColumnBuffer columns{};
+		columns.resize(sharedContext.width);
+		std::vector<char> image(sharedContext.width * sharedContext.height * 3);
+
+		RenderContext context{ sharedContext };
+		context.screen = screen.data();
+		context.columns = &columns;
+		context.debug = nullptr;
+
+		Camera camera{};
+		int frame{};
+
+		while (nextPose(queue, context, camera, frame))
+		{
+			std::fill(screen.begin(), screen.end(), 0);
+
+			context.camera = camera;
+			renderColumns(context, 0, context.width);
+
+			convertToRgb(screen.data(), context.width, context.height, image);
+
+			bool written{};
+
+			if (settings.packed)
+			{
+				// Frames are all the same size, so each one has its own spot in the file no matter which order they finish in
+				std::lock_guard<std::mutex> guard{ queue.packedLock };
+				queue.packed.seekp(static_cast<std::streamoff>(frame) * image.size());
+				written = writePackedFrame(queue.packed, image);
+			}
+			else
+				written = writeFrameImage(frameImagePath(settings.output, frame), image, context.width, context.height);
+
+			if (written)
+				framesRendered++;
+			else
+			{
+				// Only the first failure is printed. The rest are counted, and the total is printed at the end
+				std::lock_guard<std::mutex> guard{ queue.lock };
+				if (queue.framesFailed == 0)
+					std::cout << "Error writing frame " << frame << " to " << settings.output << '\n';
+				queue.framesFailed++;
+			}
+		}
+	}
+}
+
+bool runBatch(const RenderContext& context, LightingMode lighting, const BatchSettings& settings)
+{
+	// There is nobody to look at the overhead view, so the batch always uses the kernel without debug capture
+	ColumnRenderer renderColumns{ selectColumnRenderer(context, false, lighting) };
+	if (!renderColumns)
+		return false;
+
+	BatchQueue queue{};
+
+	queue.jobs.open(settings.jobFile);
+	if (!queue.jobs)
+	{
+		std::cout << "Error opening job file: " << settings.jobFile << '\n';
+		return false;
+	}
+
+	if (settings.packed)
+	{
+		queue.packed.open(settings.output, std::ios::binary | std::ios::trunc);
+		if (!queue.packed)
+		{
+			std::cout << "Error opening output file: " << settings.output << '\n';
+			return false;
+		}
+	}
+
+	int threadCount{ settings.threads > 0 ? settings.threads : static_cast<int>(std::thread::hardware_concurrency()) };
+	threadCount = std::max(threadCount, 1);
+
+	std::vector<int> framesRendered(threadCount, 0);
+	std::vector<std::thread> workers{};
+
+	Uint64 start{ SDL_GetPerformanceCounter() };
+
+	for (int i{ 0 }; i < threadCount; i++)
+		workers.emplace_back(renderJobs, std::ref(queue), std::cref(context), renderColumns, std::cref(settings), std::ref(framesRendered[i]));
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	// Whatever is still buffered is written now, so it can only fail here
+	bool packedFinished{ !settings.packed || finishPackedFile(queue.packed) };
+
+	double seconds{ static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency() };
+
+	int totalFrames{ 0 };
+	for (int frames : framesRendered)
+		totalFrames += frames;
+
+	double framesPerSecond{ seconds > 0.0 ? totalFrames / seconds : 0.0 };
+
+	std::cout << "Rendered " << totalFrames << " frames in " << seconds << " seconds on " << threadCount << " threads\n";
+	std::cout << "Throughput: " << framesPerSecond << " frames per second, " << framesPerSecond / threadCount << " per thread\n";
+
+	if (queue.framesFailed > 0)
+	{
+		std::cout << queue.framesFailed << " frames couldn't be written\n";
+		return false;
+	}
+
+	if (!packedFinished)
+	{
+		std::cout << "Error writing the end of " << settings.output << '\n';
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,22 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "Renderer.h"
+#include <string>
+
+// Settings for rendering a job file of camera poses without opening a window
+struct BatchSettings
+{
+	std::string jobFile{};		// One pose per line: x y theta pitch height. Blank lines and lines starting with '#' are skipped
+	std::string output{};		// Prefix for the image files, or the name of the packed file
+	bool packed{ false };		// Write every frame into one file of raw RGB frames instead of one PPM image per frame
+	int threads{ 0 };			// Number of worker threads. 0 uses one per core
+};
+
+// Render every pose in the job file across the worker threads and write the frames to disk. Each worker owns one frame buffer, and
+// the job file is read a line at a time as workers ask for more, so memory use doesn't grow with the number of jobs. Prints the
+// throughput when it is done. Returns false if the job file or the output couldn't be opened, a frame couldn't be written, or
+// there is no kernel for the textures
+bool runBatch(const RenderContext& context, LightingMode lighting, const BatchSettings& settings);
+
+#endif
@@ -0,0 +1,479 @@
+#include "ChunkedWorld.h"
+#include "Angles.h"
+#include "Map.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	const int32_t worldMagic{ 0x31574352 };		// "RCW1" in a little endian file
+	const std::streamoff headerSize{ 4 * sizeof(int32_t) };
+
+	// Write the header, then every chunk in order, asking cellAt(gridX, gridY) for each cell. Only one chunk is held in memory
+	template <typename CellFunction>
+	bool writeChunks(const std::string& path, int width, int height, CellFunction cellAt)
+	{
+		std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+		if (!file)
+		{
+			std::cout << "Error opening world file for writing: " << path << '\n';
+			return false;
+		}
+
+		const int chunkSize{ ChunkedWorld::CHUNK_SIZE };
+		int32_t header[4]{ worldMagic, width, height, chunkSize };
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+		int chunksWide{ (width + chunkSize - 1) / chunkSize };
+		int chunksHigh{ (height + chunkSize - 1) / chunkSize };
+		std::vector<char> chunk(ChunkedWorld::CHUNK_CELLS);
+
+		for (int chunkY{ 0 }; chunkY < chunksHigh; chunkY++)
+		{
+			for (int chunkX{ 0 }; chunkX < chunksWide; chunkX++)
+			{
+				for (int y{ 0 }; y < chunkSize; y++)
+				{
+					for (int x{ 0 }; x < chunkSize; x++)
+					{
+						int gridX{ chunkX * chunkSize + x };
+						int gridY{ chunkY * chunkSize + y };
+
+						// The last row and column of chunks are padded out with walls
+						chunk[y * chunkSize + x] = gridX < width && gridY < height ? cellAt(gridX, gridY) : Map::WALL;
+					}
+				}
+
+				file.write(chunk.data(), chunk.size());
+			}
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	// Mix a position and a seed into a random looking number
+	inline uint32_t hash(int x, int y, unsigned int seed)
+	{
+		uint32_t h{ static_cast<uint32_t>(x) * 374761393u + static_cast<uint32_t>(y) * 668265263u + seed * 2246822519u };
+		h = (h ^ (h >> 13)) * 1274126177u;
+		return h ^ (h >> 16);
+	}
+
+	// A world of 16 by 16 rooms. Every wall between two rooms has an opening in the middle, which is either open, a door or walled
+	// up, and the rooms have a few pillars in them
+	char generatedCell(int gridX, int gridY, int width, int height, unsigned int seed)
+	{
+		const int roomSize{ 16 };
+
+		if (gridX == 0 || gridY == 0 || gridX == width - 1 || gridY == height - 1)
+			return Map::WALL;
+
+		// Where the player starts
+		if (gridX < 10 && gridY < 10)
+			return Map::EMPTY;
+
+		int roomX{ gridX % roomSize };
+		int roomY{ gridY % roomSize };
+
+		if (roomX == 0 && roomY == 0)
+			return Map::WALL;
+
+		if (roomX == 0 || roomY == 0)
+		{
+			// The opening in the middle of this wall. The walls on either side of it are what a door needs to slide into
+			bool opening{ roomX == 0 ? roomY == roomSize / 2 : roomX == roomSize / 2 };
+			if (!opening)
+				return Map::WALL;
+
+			switch (hash(gridX / roomSize, gridY / roomSize, seed + (roomX == 0 ? 0 : 1)) % 4)
+			{
+			case 0:
+				return Map::WALL;
+			case 1:
+				return Map::DOOR;
+			default:
+				return Map::EMPTY;
+			}
+		}
+
+		// Pillars stay away from the walls, so they never block an opening or end up next to a door
+		if (roomX >= 2 && roomX <= roomSize - 2 && roomY >= 2 && roomY <= roomSize - 2 && hash(gridX, gridY, seed) % 100 < 4)
+			return Map::WALL;
+
+		return Map::EMPTY;
+	}
+}
+
+ChunkedWorld::ChunkedWorld(const std::string& path, int maxChunks)
+	: m_maxChunks{ std::max(maxChunks, 1) }, m_loaderFile{ path, std::ios::binary }, m_file{ path, std::ios::binary }
+{
+	int32_t header[4]{};
+	m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	if (!m_file || !m_loaderFile || header[0] != worldMagic || header[3] != CHUNK_SIZE || header[1] <= 0 || header[2] <= 0)
+	{
+		std::cout << "Error opening world file: " << path << '\n';
+		return;
+	}
+
+	m_width = header[1];
+	m_height = header[2];
+	m_chunksWide = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	m_chunksHigh = (m_height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	m_loader = std::thread{ &ChunkedWorld::loaderLoop, this };
+}
+
+ChunkedWorld::~ChunkedWorld()
+{
+	{
+		std::lock_guard<std::mutex> guard{ m_lock };
+		m_stopping = true;
+	}
+	m_wake.notify_one();
+
+	if (m_loader.joinable())
+		m_loader.join();
+}
+
+bool ChunkedWorld::readChunk(std::ifstream& file, int64_t chunk, std::vector<char>& cells) const
+{
+	cells.resize(CHUNK_CELLS);
+
+	file.clear();
+	file.seekg(headerSize + static_cast<std::streamoff>(chunk) * CHUNK_CELLS);
+	file.read(cells.data(), CHUNK_CELLS);
+
+	return static_cast<bool>(file);
+}
+
+void ChunkedWorld::insert(int64_t chunk, std::vector<char>& cells)
+{
+	if (m_cache.count(chunk))
+	{
+		touch(chunk);
+		return;
+	}
+
+	m_leastRecentlyUsed.push_front(chunk);
+
+	CachedChunk& cached{ m_cache[chunk] };
+	cached.cells.swap(cells);
+	cached.used = m_leastRecentlyUsed.begin();
+
+	// Make room by dropping the chunks which haven't been used for the longest
+	while (static_cast<int>(m_cache.size()) > m_maxChunks)
+	{
+		m_cache.erase(m_leastRecentlyUsed.back());
+		m_leastRecentlyUsed.pop_back();
+	}
+}
+
+void ChunkedWorld::touch(int64_t chunk)
+{
+	m_leastRecentlyUsed.splice(m_leastRecentlyUsed.begin(), m_leastRecentlyUsed, m_cache[chunk].used);
+}
+
+const char* ChunkedWorld::chunk(int chunkX, int chunkY) const
+{
+	if (chunkX < 0 || chunkX >= m_chunksWide || chunkY < 0 || chunkY >= m_chunksHigh)
+		return nullptr;
+
+	auto cached{ m_cache.find(key(chunkX, chunkY)) };
+	return cached == m_cache.end() ? nullptr : cached->second.cells.data();
+}
+
+char ChunkedWorld::at(int gridX, int gridY) const
+{
+	if (gridX < 0 || gridX >= m_width || gridY < 0 || gridY >= m_height)
+		return Map::WALL;
+
+	const char* cells{ chunk(gridX / CHUNK_SIZE, gridY / CHUNK_SIZE) };
+	if (!cells)
+		return Map::WALL;
+
+	return cells[(gridY % CHUNK_SIZE) * CHUNK_SIZE + gridX % CHUNK_SIZE];
+}
+
+void ChunkedWorld::load(int chunkX, int chunkY)
+{
+	if (chunkX < 0 || chunkX >= m_chunksWide || chunkY < 0 || chunkY >= m_chunksHigh)
+		return;
+
+	int64_t chunk{ key(chunkX, chunkY) };
+	if (m_cache.count(chunk))
+	{
+		touch(chunk);
+		return;
+	}
+
+	// If the loader thread is reading it too, its copy is thrown away when it arrives
+	std::vector<char> cells{};
+	if (readChunk(m_file, chunk, cells))
+		insert(chunk, cells);
+	else
+		std::cout << "Error reading chunk " << chunkX << ", " << chunkY << " of the world file\n";
+}
+
+void ChunkedWorld::request(int chunkX, int chunkY)
+{
+	if (chunkX < 0 || chunkX >= m_chunksWide || chunkY < 0 || chunkY >= m_chunksHigh)
+		return;
+
+	int64_t chunk{ key(chunkX, chunkY) };
+	if (m_cache.count(chunk))
+	{
+		touch(chunk);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard{ m_lock };
+
+		if (m_pending.count(chunk))
+			return;
+
+		// If the player moves faster than the disk keeps up, the oldest requests are the least likely to still be needed
+		if (static_cast<int>(m_requests.size()) >= m_maxChunks)
+		{
+			m_pending.erase(m_requests.front());
+			m_requests.pop_front();
+		}
+
+		m_pending.insert(chunk);
+		m_requests.push_back(chunk);
+	}
+
+	m_wake.notify_one();
+}
+
+const std::vector<int64_t>& ChunkedWorld::update()
+{
+	m_arrived.clear();
+
+	std::vector<std::pair<int64_t, std::vector<char>>> loaded{};
+	{
+		std::lock_guard<std::mutex> guard{ m_lock };
+		loaded.swap(m_loaded);
+
+		for (const auto& chunk : loaded)
+			m_pending.erase(chunk.first);
+	}
+
+	for (auto& chunk : loaded)
+	{
+		if (m_cache.count(chunk.first))
+			continue;
+
+		insert(chunk.first, chunk.second);
+		m_arrived.push_back(chunk.first);
+	}
+
+	return m_arrived;
+}
+
+void ChunkedWorld::loaderLoop()
+{
+	while (true)
+	{
+		int64_t chunk{};
+		{
+			std::unique_lock<std::mutex> guard{ m_lock };
+			m_wake.wait(guard, [this]() { return m_stopping || !m_requests.empty(); });
+
+			if (m_stopping)
+				return;
+
+			chunk = m_requests.front();
+			m_requests.pop_front();
+		}
+
+		// The file is read without the lock held, so the main thread never waits on the disk
+		std::vector<char> cells{};
+		bool succeeded{ readChunk(m_loaderFile, chunk, cells) };
+
+		std::lock_guard<std::mutex> guard{ m_lock };
+
+		// A chunk which couldn't be read stays pending, so it isn't asked for again every frame. It just stays walls
+		if (succeeded)
+			m_loaded.emplace_back(chunk, std::move(cells));
+	}
+}
+
+bool ChunkedWorld::write(const std::string& path, const std::string& cells, int width, int height)
+{
+	return writeChunks(path, width, height, [&cells, width](int gridX, int gridY) { return cells[gridY * width + gridX]; });
+}
+
+bool ChunkedWorld::generate(const std::string& path, int width, int height, unsigned int seed)
+{
+	return writeChunks(path, width, height, [width, height, seed](int gridX, int gridY) { return generatedCell(gridX, gridY, width, height, seed); });
+}
+
+WorldWindow::WorldWindow(ChunkedWorld& world, Map& map)
+	: m_world{ world }, m_map{ map }, m_filled(WINDOW_CHUNKS * WINDOW_CHUNKS, false)
+{
+
+}
+
+void WorldWindow::fill(int windowChunkX, int windowChunkY)
+{
+	const int chunkSize{ ChunkedWorld::CHUNK_SIZE };
+	const char* cells{ m_world.chunk(m_originChunkX + windowChunkX, m_originChunkY + windowChunkY) };
+
+	m_filled[windowChunkY * WINDOW_CHUNKS + windowChunkX] = cells != nullptr;
+
+	int left{ windowChunkX * chunkSize };
+	int top{ windowChunkY * chunkSize };
+	int worldLeft{ m_originChunkX * chunkSize + left };
+	int worldTop{ m_originChunkY * chunkSize + top };
+
+	// Doors go in after everything else, because which way a door faces depends on the cells next to it. They are always set
+	// again, since the door that was in the cell before might have been facing the other way. That closes them, so update()
+	// puts back the state of any door which was already in the window
+	for (int pass{ 0 }; pass < 2; pass++)
+	{
+		for (int y{ 0 }; y < chunkSize; y++)
+		{
+			for (int x{ 0 }; x < chunkSize; x++)
+			{
+				char cell{ cells ? cells[y * chunkSize + x] : Map::WALL };
+				uint8_t textureId{ static_cast<uint8_t>(cell == Map::DOOR ? Map::DOOR_TEXTURE : 0) };
+
+				// The player's changes go over the world's cells. A chunk which hasn't arrived yet stays all walls
+				if (cells && !m_edits.empty())
+				{
+					auto edit{ m_edits.find(worldKey(worldLeft + x, worldTop + y)) };
+					if (edit != m_edits.end())
+					{
+						cell = edit->second.cell;
+						textureId = edit->second.textureId;
+					}
+				}
+
+				if ((cell == Map::DOOR) != (pass == 1))
+					continue;
+
+				if (cell == Map::DOOR || m_map.at(left + x, top + y) != cell || m_map.textureId(left + x, top + y) != textureId)
+					m_map.setCell(left + x, top + y, cell, textureId);
+			}
+		}
+	}
+}
+
+void WorldWindow::setCell(int gridX, int gridY, char cell, uint8_t textureId)
+{
+	const int chunkSize{ ChunkedWorld::CHUNK_SIZE };
+
+	m_edits[worldKey(m_originChunkX * chunkSize + gridX, m_originChunkY * chunkSize + gridY)] = EditedCell{ cell, textureId };
+	m_map.setCell(gridX, gridY, cell, textureId);
+}
+
+bool WorldWindow::update(float playerX, float playerY, float theta, int& shiftX, int& shiftY)
+{
+	const int chunkSize{ ChunkedWorld::CHUNK_SIZE };
+	const int gridSize{ m_map.gridSize() };
+
+	shiftX = 0;
+	shiftY = 0;
+
+	// The chunk of the window the player is in
+	int playerChunkX{ std::min(std::max(static_cast<int>(playerX / gridSize) / chunkSize, 0), WINDOW_CHUNKS - 1) };
+	int playerChunkY{ std::min(std::max(static_cast<int>(playerY / gridSize) / chunkSize, 0), WINDOW_CHUNKS - 1) };
+
+	bool moved{ false };
+
+	// Move the window once the player is in one of the chunks around its edge, unless the world ends there anyway
+	if (!m_started || playerChunkX == 0 || playerChunkX == WINDOW_CHUNKS - 1 || playerChunkY == 0 || playerChunkY == WINDOW_CHUNKS - 1)
+	{
+		int originX{ std::min(std::max(m_originChunkX + playerChunkX - WINDOW_CHUNKS / 2, 0), std::max(m_world.chunksWide() - WINDOW_CHUNKS, 0)) };
+		int originY{ std::min(std::max(m_originChunkY + playerChunkY - WINDOW_CHUNKS / 2, 0), std::max(m_world.chunksHigh() - WINDOW_CHUNKS, 0)) };
+
+		if (!m_started || originX != m_originChunkX || originY != m_originChunkY)
+		{
+			int chunksX{ originX - m_originChunkX };
+			int chunksY{ originY - m_originChunkY };
+
+			shiftX = chunksX * chunkSize;
+			shiftY = chunksY * chunkSize;
+			playerChunkX -= chunksX;
+			playerChunkY -= chunksY;
+
+			// Remember the doors that aren't closed by where they are in the world, so the ones which are still in the window
+			// afterwards can be put back the way they were. Otherwise every door the player opened would shut behind them
+			std::vector<SavedDoor> savedDoors{};
+			for (const Map::Door& door : m_map.doors())
+			{
+				if (door.open != 0.0f || door.target != 0.0f)
+					savedDoors.push_back(SavedDoor{ m_originChunkX * chunkSize + door.gridX, m_originChunkY * chunkSize + door.gridY, door.open, door.target });
+			}
+
+			m_originChunkX = originX;
+			m_originChunkY = originY;
+			moved = m_started;
+			m_started = true;
+
+			// Chunks which are already loaded go in straight away, and the rest are walls until they arrive
+			for (int y{ 0 }; y < WINDOW_CHUNKS; y++)
+			{
+				for (int x{ 0 }; x < WINDOW_CHUNKS; x++)
+					fill(x, y);
+			}
+
+			for (const SavedDoor& door : savedDoors)
+				m_map.setDoorState(door.worldX - m_originChunkX * chunkSize, door.worldY - m_originChunkY * chunkSize, door.open, door.target);
+		}
+	}
+
+	// The chunks around the player can't wait for the loader thread, or the player could end up inside of a wall that hasn't loaded
+	for (int y{ playerChunkY - 1 }; y <= playerChunkY + 1; y++)
+	{
+		for (int x{ playerChunkX - 1 }; x <= playerChunkX + 1; x++)
+		{
+			if (x < 0 || x >= WINDOW_CHUNKS || y < 0 || y >= WINDOW_CHUNKS || m_filled[y * WINDOW_CHUNKS + x])
+				continue;
+
+			m_world.load(m_originChunkX + x, m_originChunkY + y);
+			fill(x, y);
+		}
+	}
+
+	// Prefetch the chunks in the direction the player is looking first, out past the edge of the window, since that is where the
+	// window will move to. Then the rest of the window
+	float directionX{ cosf(radians(theta)) };
+	float directionY{ -sinf(radians(theta)) };
+
+	int worldPlayerChunkX{ m_originChunkX + playerChunkX };
+	int worldPlayerChunkY{ m_originChunkY + playerChunkY };
+
+	for (int step{ 1 }; step <= WINDOW_CHUNKS; step++)
+	{
+		int aheadX{ worldPlayerChunkX + static_cast<int>(floorf(directionX * step + 0.5f)) };
+		int aheadY{ worldPlayerChunkY + static_cast<int>(floorf(directionY * step + 0.5f)) };
+
+		for (int y{ aheadY - 1 }; y <= aheadY + 1; y++)
+		{
+			for (int x{ aheadX - 1 }; x <= aheadX + 1; x++)
+				m_world.request(x, y);
+		}
+	}
+
+	for (int y{ 0 }; y < WINDOW_CHUNKS; y++)
+	{
+		for (int x{ 0 }; x < WINDOW_CHUNKS; x++)
+			m_world.request(m_originChunkX + x, m_originChunkY + y);
+	}
+
+	// Copy in the chunks the loader thread has finished
+	for (int64_t chunk : m_world.update())
+	{
+		int x{ static_cast<int>(chunk % m_world.chunksWide()) - m_originChunkX };
+		int y{ static_cast<int>(chunk / m_world.chunksWide()) - m_originChunkY };
+
+		if (x >= 0 && x < WINDOW_CHUNKS && y >= 0 && y < WINDOW_CHUNKS && !m_filled[y * WINDOW_CHUNKS + x])
+			fill(x, y);
+	}
+
+	return moved;
+}
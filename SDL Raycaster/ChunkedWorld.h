@@ -0,0 +1,168 @@
+#ifndef CHUNKEDWORLD_H
+#define CHUNKEDWORLD_H
+
+#include "Map.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// A world too big to keep in memory, stored on disk in square chunks of cells. Only the chunks near the player are kept in memory,
+// in a cache with a fixed number of chunks, and a background thread reads the chunks the player is heading towards before they are
+// needed. A cell in a chunk which isn't loaded counts as a wall, so rays and bodies stop at the edge of what has been loaded instead
+// of going through walls which just haven't been read yet
+//
+// A world file starts with a header of four 32-bit integers (a magic number, the width and height in cells and the chunk size),
+// then the chunks one row of chunks at a time. Every chunk is CHUNK_SIZE * CHUNK_SIZE cells, so any chunk can be found with one seek
+class ChunkedWorld
+{
+public:
+	static const int CHUNK_SIZE{ 64 };
+	static const int CHUNK_CELLS{ CHUNK_SIZE * CHUNK_SIZE };
+
+private:
+	struct CachedChunk
+	{
+		std::vector<char> cells{};
+		std::list<int64_t>::iterator used{};	// Position in m_leastRecentlyUsed
+	};
+
+	int m_width{};			// Size of the world in cells
+	int m_height{};
+	int m_chunksWide{};
+	int m_chunksHigh{};
+	int m_maxChunks{};		// Most chunks the cache holds before it starts dropping the least recently used ones
+
+	std::unordered_map<int64_t, CachedChunk> m_cache{};
+	std::list<int64_t> m_leastRecentlyUsed{};	// The front is the most recently used
+	std::vector<int64_t> m_arrived{};			// Chunks which were added to the cache by the last update()
+
+	// Shared with the loader thread. Only touched with m_lock held
+	std::mutex m_lock{};
+	std::condition_variable m_wake{};
+	std::deque<int64_t> m_requests{};
+	std::unordered_set<int64_t> m_pending{};	// Chunks which have been requested but aren't in the cache yet
+	std::vector<std::pair<int64_t, std::vector<char>>> m_loaded{};
+	bool m_stopping{ false };
+
+	std::ifstream m_loaderFile{};	// Only read by the loader thread
+	std::ifstream m_file{};			// Only read by load(), on the main thread
+	std::thread m_loader{};
+
+	int64_t key(int chunkX, int chunkY) const { return static_cast<int64_t>(chunkY) * m_chunksWide + chunkX; }
+
+	bool readChunk(std::ifstream& file, int64_t chunk, std::vector<char>& cells) const;
+	void insert(int64_t chunk, std::vector<char>& cells);
+	void touch(int64_t chunk);
+	void loaderLoop();
+
+public:
+	// Opens the world file. maxChunks should be comfortably more than the chunks prefetched around the player, or the cache will
+	// drop chunks that are about to be used again
+	ChunkedWorld(const std::string& path, int maxChunks = 256);
+	~ChunkedWorld();
+
+	ChunkedWorld(const ChunkedWorld&) = delete;
+	ChunkedWorld& operator=(const ChunkedWorld&) = delete;
+
+	bool isOpen() const { return m_width > 0; }
+
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+	int chunksWide() const { return m_chunksWide; }
+	int chunksHigh() const { return m_chunksHigh; }
+
+	// The cells of a chunk (row by row), or nullptr if it isn't loaded
+	const char* chunk(int chunkX, int chunkY) const;
+
+	// A cell of the world. Cells in chunks which aren't loaded, and cells outside of the world, are walls
+	char at(int gridX, int gridY) const;
+
+	// Read a chunk right now, if it isn't loaded already. For the chunks the player is standing in, which can't wait
+	void load(int chunkX, int chunkY);
+
+	// Ask the loader thread for a chunk, if it isn't loaded or already on its way. Chunks are read in the order they are asked for.
+	// A chunk which is already loaded counts as used, which keeps it in the cache
+	void request(int chunkX, int chunkY);
+
+	// Move the chunks the loader thread has finished into the cache, and drop the least recently used chunks if there are too
+	// many. Returns the chunks which were added, as chunkY * chunksWide() + chunkX
+	const std::vector<int64_t>& update();
+
+	// Write a world file from a map in memory, padded with walls to a whole number of chunks
+	static bool write(const std::string& path, const std::string& cells, int width, int height);
+
+	// Write a world file of rooms and corridors, a chunk at a time, so worlds much bigger than memory can be made. Each cell only
+	// depends on its position and the seed. The top left corner is kept open for the player to start in
+	static bool generate(const std::string& path, int width, int height, unsigned int seed);
+};
+
+// Keeps a Map filled with the part of a ChunkedWorld around the player, so everything built on Map (the renderer, the lightmap,
+// collision, ray queries) works on a huge world without any changes. The window is a fixed number of chunks across. When the player
+// gets close to its edge, it moves by whole chunks to put the player back in the middle, and everything positioned in the window
+// has to be moved back by the same amount. Cells are changed with Map::setCell(), so only the cells which actually change show up
+// in Map::changedCells(). Doors keep their state while they stay in the window. Cells changed through WorldWindow::setCell() (like
+// knocking down walls) stay changed when the window moves away and back, for as long as the window is around, but aren't saved
+// back to the world file
+class WorldWindow
+{
+public:
+	static const int WINDOW_CHUNKS{ 4 };
+	static const int WINDOW_CELLS{ WINDOW_CHUNKS * ChunkedWorld::CHUNK_SIZE };
+
+private:
+	ChunkedWorld& m_world;
+	Map& m_map;
+	int m_originChunkX{ 0 };	// Chunk of the world at the top left of the window
+	int m_originChunkY{ 0 };
+	std::vector<bool> m_filled{};	// For each chunk of the window, whether it holds the world's cells yet or is still walls
+	bool m_started{ false };
+
+	// A door which is carried over when the window moves
+	struct SavedDoor
+	{
+		int worldX{};
+		int worldY{};
+		float open{};
+		float target{};
+	};
+
+	// A cell which was changed with setCell(), kept by where it is in the world so it survives the window moving
+	struct EditedCell
+	{
+		char cell{};
+		uint8_t textureId{};
+	};
+	std::unordered_map<int64_t, EditedCell> m_edits{};
+
+	int64_t worldKey(int worldX, int worldY) const { return static_cast<int64_t>(worldY) * m_world.width() + worldX; }
+
+	void fill(int windowChunkX, int windowChunkY);
+
+public:
+	// map has to be WINDOW_CELLS by WINDOW_CELLS
+	WorldWindow(ChunkedWorld& world, Map& map);
+
+	// Call once per frame with the player's position in the window, in pixels. Loads the chunks around the player, prefetches the
+	// ones ahead of them, copies in chunks which have arrived, and moves the window if the player is near its edge. Returns true if
+	// the window moved, in which case shiftX and shiftY are how many cells it moved by
+	bool update(float playerX, float playerY, float theta, int& shiftX, int& shiftY);
+
+	// Change a cell of the window the same way as Map::setCell(), and remember the change, so the cell is put back that way every time
+	// its chunk is copied into the window again. Use it instead of changing the map directly
+	void setCell(int gridX, int gridY, char cell, uint8_t textureId);
+
+	// The world cell at the top left of the window
+	int originX() const { return m_originChunkX * ChunkedWorld::CHUNK_SIZE; }
+	int originY() const { return m_originChunkY * ChunkedWorld::CHUNK_SIZE; }
+};
+
+#endif
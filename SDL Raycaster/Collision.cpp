@@ -0,0 +1,289 @@
+#include "Collision.h"
+#include "Map.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Bodies stop this far (in pixels) away from a wall. Without the gap, a body sliding along a wall would be exactly touching it,
+	// and rounding would have it hit the corners of the blocks it is sliding past
+	const float skin{ 0.01f };
+
+	// Walls one move can be turned by. Two is enough for any corner of the grid, and whatever is left after that is dropped, so
+	// a body can stop early but never go through a wall
+	const int maxSlides{ 4 };
+
+	// When a circle of the given radius moving from (x, y) by (dx, dy) first touches the point (cornerX, cornerY), as a fraction of
+	// the move. Returns false if it never does, or is moving away from it
+	bool sweepCorner(float x, float y, float dx, float dy, float cornerX, float cornerY, float radius, float& t)
+	{
+		float offsetX{ x - cornerX };
+		float offsetY{ y - cornerY };
+
+		// Solve |offset + (dx, dy) * t| = radius for t
+		float a{ dx * dx + dy * dy };
+		float halfB{ offsetX * dx + offsetY * dy };
+		float c{ offsetX * offsetX + offsetY * offsetY - radius * radius };
+
+		if (a == 0.0f || halfB >= 0.0f)
+			return false;
+
+		float discriminant{ halfB * halfB - a * c };
+		if (discriminant < 0.0f)
+			return false;
+
+		// A circle which already overlaps the corner (by a rounding error) is stopped right where it is
+		t = std::max((-halfB - sqrtf(discriminant)) / a, 0.0f);
+		return true;
+	}
+}
+
+CollisionWorld::CollisionWorld(float timeStep, int maxStepsPerUpdate)
+	: m_timeStep{ timeStep }, m_maxStepsPerUpdate{ maxStepsPerUpdate }
+{
+
+}
+
+int CollisionWorld::update(const Map& gridMap, float deltaTime)
+{
+	m_accumulator += deltaTime;
+
+	int steps{ 0 };
+	while (m_accumulator >= m_timeStep && steps < m_maxStepsPerUpdate)
+	{
+		// All of the bodies are moved in one pass over the array
+		for (Body& body : bodies)
+		{
+			body.previousX = body.x;
+			body.previousY = body.y;
+
+			if (body.velocityX != 0.0f || body.velocityY != 0.0f)
+				move(gridMap, body, body.velocityX * m_timeStep, body.velocityY * m_timeStep);
+		}
+
+		m_accumulator -= m_timeStep;
+		steps++;
+	}
+
+	// Drop the time that couldn't be simulated
+	if (steps == m_maxStepsPerUpdate)
+		m_accumulator = std::min(m_accumulator, m_timeStep);
+
+	return steps;
+}
+
+void CollisionWorld::move(const Map& gridMap, Body& body, float dx, float dy)
+{
+	// The sweep assumes the body starts out of the walls
+	resolve(gridMap, body);
+
+	for (int slide{ 0 }; slide < maxSlides && (dx != 0.0f || dy != 0.0f); slide++)
+	{
+		float normalX{};
+		float normalY{};
+		float t{ sweep(gridMap, body, dx, dy, normalX, normalY) };
+
+		if (t > 1.0f)
+		{
+			body.x += dx;
+			body.y += dy;
+			return;
+		}
+
+		// Go up to the wall, and back off from it a little
+		body.x += dx * t + normalX * skin;
+		body.y += dy * t + normalY * skin;
+
+		// Take the part of the rest of the move that goes into the wall away. What is left runs along the wall, which is what makes
+		// the body slide
+		float restX{ dx * (1.0f - t) };
+		float restY{ dy * (1.0f - t) };
+		float intoWall{ restX * normalX + restY * normalY };
+
+		dx = restX - intoWall * normalX;
+		dy = restY - intoWall * normalY;
+	}
+}
+
+float CollisionWorld::sweep(const Map& gridMap, const Body& body, float dx, float dy, float& normalX, float& normalY)
+{
+	const int gridSize{ gridMap.gridSize() };
+	const float radius{ body.radius };
+
+	float earliest{ 2.0f };
+
+	// The grid blocks the circle's bounding box covers anywhere along the move
+	int firstX{ static_cast<int>(floorf((std::min(body.x, body.x + dx) - radius) / gridSize)) };
+	int firstY{ static_cast<int>(floorf((std::min(body.y, body.y + dy) - radius) / gridSize)) };
+	int lastX{ static_cast<int>(floorf((std::max(body.x, body.x + dx) + radius) / gridSize)) };
+	int lastY{ static_cast<int>(floorf((std::max(body.y, body.y + dy) + radius) / gridSize)) };
+
+	for (int gridY{ firstY }; gridY <= lastY; gridY++)
+	{
+		for (int gridX{ firstX }; gridX <= lastX; gridX++)
+		{
+			if (!gridMap.isSolid(gridX, gridY))
+				continue;
+
+			float left{ static_cast<float>(gridX * gridSize) };
+			float top{ static_cast<float>(gridY * gridSize) };
+			float right{ left + gridSize };
+			float bottom{ top + gridSize };
+
+			// The circle touches a side of the block when its center reaches the side moved out by the radius. Only the sides the
+			// body is moving towards can stop it, and only if the center is still on the outside of them
+			if (dx > 0.0f && body.x <= left)
+			{
+				float t{ std::max((left - radius - body.x) / dx, 0.0f) };
+				float y{ body.y + dy * t };
+
+				if (t < earliest && y >= top && y <= bottom)
+				{
+					earliest = t;
+					normalX = -1.0f;
+					normalY = 0.0f;
+				}
+			}
+			else if (dx < 0.0f && body.x >= right)
+			{
+				float t{ std::max((right + radius - body.x) / dx, 0.0f) };
+				float y{ body.y + dy * t };
+
+				if (t < earliest && y >= top && y <= bottom)
+				{
+					earliest = t;
+					normalX = 1.0f;
+					normalY = 0.0f;
+				}
+			}
+
+			if (dy > 0.0f && body.y <= top)
+			{
+				float t{ std::max((top - radius - body.y) / dy, 0.0f) };
+				float x{ body.x + dx * t };
+
+				if (t < earliest && x >= left && x <= right)
+				{
+					earliest = t;
+					normalX = 0.0f;
+					normalY = -1.0f;
+				}
+			}
+			else if (dy < 0.0f && body.y >= bottom)
+			{
+				float t{ std::max((bottom + radius - body.y) / dy, 0.0f) };
+				float x{ body.x + dx * t };
+
+				if (t < earliest && x >= left && x <= right)
+				{
+					earliest = t;
+					normalX = 0.0f;
+					normalY = 1.0f;
+				}
+			}
+
+			// Past the ends of the sides, the circle touches the corners
+			const float cornersX[4]{ left, right, left, right };
+			const float cornersY[4]{ top, top, bottom, bottom };
+
+			for (int corner{ 0 }; corner < 4; corner++)
+			{
+				float t{};
+				if (!sweepCorner(body.x, body.y, dx, dy, cornersX[corner], cornersY[corner], radius, t) || t >= earliest)
+					continue;
+
+				// The circle only touches the corner itself when it isn't already touching one of the sides next to it
+				float x{ body.x + dx * t };
+				float y{ body.y + dy * t };
+				if ((x >= left && x <= right) || (y >= top && y <= bottom))
+					continue;
+
+				float offsetX{ x - cornersX[corner] };
+				float offsetY{ y - cornersY[corner] };
+				float length{ sqrtf(offsetX * offsetX + offsetY * offsetY) };
+				if (length == 0.0f)
+					continue;
+
+				earliest = t;
+				normalX = offsetX / length;
+				normalY = offsetY / length;
+			}
+		}
+	}
+
+	return earliest;
+}
+
+void CollisionWorld::resolve(const Map& gridMap, Body& body)
+{
+	const int gridSize{ gridMap.gridSize() };
+
+	// Pushing out of one wall can push the body into another in a corner, so go over them twice
+	for (int pass{ 0 }; pass < 2; pass++)
+	{
+		// The grid blocks the circle's bounding box covers
+		int firstX{ static_cast<int>(floorf((body.x - body.radius) / gridSize)) };
+		int firstY{ static_cast<int>(floorf((body.y - body.radius) / gridSize)) };
+		int lastX{ static_cast<int>(floorf((body.x + body.radius) / gridSize)) };
+		int lastY{ static_cast<int>(floorf((body.y + body.radius) / gridSize)) };
+
+		bool pushed{ false };
+
+		for (int gridY{ firstY }; gridY <= lastY; gridY++)
+		{
+			for (int gridX{ firstX }; gridX <= lastX; gridX++)
+			{
+				if (!gridMap.isSolid(gridX, gridY))
+					continue;
+
+				float left{ static_cast<float>(gridX * gridSize) };
+				float top{ static_cast<float>(gridY * gridSize) };
+				float right{ left + gridSize };
+				float bottom{ top + gridSize };
+
+				// The point on the block closest to the center of the circle
+				float closestX{ std::max(left, std::min(body.x, right)) };
+				float closestY{ std::max(top, std::min(body.y, bottom)) };
+
+				float offsetX{ body.x - closestX };
+				float offsetY{ body.y - closestY };
+				float distanceSquared{ offsetX * offsetX + offsetY * offsetY };
+
+				if (distanceSquared >= body.radius * body.radius)
+					continue;
+
+				if (distanceSquared > 0.0f)
+				{
+					// Push the circle away from the closest point until it only touches the block
+					float distance{ sqrtf(distanceSquared) };
+					float push{ (body.radius - distance) / distance };
+					body.x += offsetX * push;
+					body.y += offsetY * push;
+				}
+				else
+				{
+					// The center is inside of the block, so push it out through the nearest side
+					float toLeft{ body.x - left };
+					float toRight{ right - body.x };
+					float toTop{ body.y - top };
+					float toBottom{ bottom - body.y };
+					float nearest{ std::min(std::min(toLeft, toRight), std::min(toTop, toBottom)) };
+
+					if (nearest == toLeft)
+						body.x = left - body.radius;
+					else if (nearest == toRight)
+						body.x = right + body.radius;
+					else if (nearest == toTop)
+						body.y = top - body.radius;
+					else
+						body.y = bottom + body.radius;
+				}
+
+				pushed = true;
+			}
+		}
+
+		if (!pushed)
+			break;
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "Map.h"
+#include <vector>
+
+// A circle that moves through the map and collides with its walls. Positions are in pixels, like playerX and playerY, and
+// velocities are in pixels per second
+struct Body
+{
+	float x{};
+	float y{};
+	float radius{};
+	float velocityX{};
+	float velocityY{};
+
+	// Where the body was before the last step. Rendering blends between this and (x, y), see CollisionWorld::interpolation(). Start
+	// these out the same as x and y
+	float previousX{};
+	float previousY{};
+};
+
+// Moves every body through the map in fixed time steps, so the result doesn't depend on the frame rate. Each move is swept: the
+// circle is traced along its whole path to the first wall it would touch, however fast it goes, so nothing can pass through a wall.
+// At the wall the rest of the move is turned to run along it, so bodies slide instead of stopping dead
+//
+// The steps don't line up with the frames, so a frame usually lands part of the way into a step. Drawing the bodies where the last
+// step left them would make them judder whenever the frame rate isn't a multiple of the step rate, so they should be drawn between
+// their previous and current positions, interpolation() of the way along
+class CollisionWorld
+{
+private:
+	float m_timeStep{};		// Length of one simulation step in seconds
+	float m_accumulator{};	// Time which has passed but hasn't been simulated yet
+	int m_maxStepsPerUpdate{};
+
+public:
+	std::vector<Body> bodies{};
+
+	CollisionWorld(float timeStep = 1.0f / 120.0f, int maxStepsPerUpdate = 8);
+
+	// Simulate deltaTime seconds worth of steps for all of the bodies, and return how many steps were taken. If the frame took so
+	// long that more than maxStepsPerUpdate steps are due, the extra time is dropped rather than letting the game fall behind
+	int update(const Map& gridMap, float deltaTime);
+
+	// How far (0 to 1) the time that has passed is into the next step. A body should be drawn at previous + (current - previous) *
+	// interpolation()
+	float interpolation() const { return m_accumulator / m_timeStep; }
+
+	// Where to draw a body this frame
+	float interpolatedX(const Body& body) const { return body.previousX + (body.x - body.previousX) * interpolation(); }
+	float interpolatedY(const Body& body) const { return body.previousY + (body.y - body.previousY) * interpolation(); }
+
+	// Move one body by (dx, dy), stopping at the first wall in the way and sliding along it
+	static void move(const Map& gridMap, Body& body, float dx, float dy);
+
+	// How far (0 to 1) along (dx, dy) the body can go before it touches a solid block, or a value greater than 1 if it doesn't hit
+	// anything. normalX and normalY are set to the direction the wall it hits faces
+	static float sweep(const Map& gridMap, const Body& body, float dx, float dy, float& normalX, float& normalY);
+
+	// Push a body out of any walls it overlaps. Sweeping never ends up inside of a wall, but the map can change under a body (a
+	// door closing on it, a wall being built where it stands)
+	static void resolve(const Map& gridMap, Body& body);
+};
+
+#endif
@@ -0,0 +1,188 @@
+#include "FrameCapture.h"
+#include "FrameFile.h"
+#include "SDL.h"
+#include <algorithm>
+#include <iostream>
+
+FrameCapture::FrameCapture(int width, int height, const CaptureSettings& settings)
+	: m_width{ width }, m_height{ height }, m_settings{ settings }
+{
+	// Everything is allocated now, so capturing a frame never allocates
+	m_slots.resize(std::max(m_settings.slots, 1));
+	for (int i{ 0 }; i < static_cast<int>(m_slots.size()); i++)
+	{
+		m_slots[i].pixels.resize(width * height);
+		m_free.push_back(i);
+	}
+
+	m_image.resize(width * height * 3);
+
+	if (m_settings.packed)
+	{
+		m_packed.open(m_settings.output, std::ios::binary | std::ios::trunc);
+		if (!m_packed)
+		{
+			std::cout << "Error opening capture file: " << m_settings.output << '\n';
+			m_open = false;
+			return;
+		}
+	}
+
+	m_writer = std::thread{ &FrameCapture::writerLoop, this };
+}
+
+FrameCapture::~FrameCapture()
+{
+	stop();
+}
+
+bool FrameCapture::stop()
+{
+	if (!m_writer.joinable())
+		return m_errors.empty();
+
+	{
+		std::lock_guard<std::mutex> guard{ m_lock };
+		m_stopping = true;
+	}
+	m_frameQueued.notify_one();
+
+	m_writer.join();
+	m_open = false;
+
+	// The writer thread is gone, so its errors can be read without the lock
+	for (const std::string& error : m_errors)
+		std::cout << error << '\n';
+
+	if (m_framesFailed > 0)
+		std::cout << m_framesFailed << " captured frames couldn't be written\n";
+
+	return m_errors.empty();
+}
+
+bool FrameCapture::capture(const uint32_t* screen, int pitch)
+{
+	Uint64 start{ SDL_GetPerformanceCounter() };
+
+	int frame{ m_nextFrame++ };
+	int slot{ -1 };
+
+	if (m_open)
+	{
+		std::unique_lock<std::mutex> guard{ m_lock };
+
+		if (m_settings.policy == CapturePolicy::BLOCK)
+			m_slotFreed.wait(guard, [this]() { return !m_free.empty(); });
+
+		if (!m_free.empty())
+		{
+			slot = m_free.back();
+			m_free.pop_back();
+		}
+	}
+
+	// The copy happens without the lock held. Nobody else touches a slot between it being taken and it being queued
+	if (slot >= 0)
+	{
+		Slot& destination{ m_slots[slot] };
+		destination.frame = frame;
+
+		for (int y{ 0 }; y < m_height; y++)
+			std::copy(screen + y * pitch, screen + y * pitch + m_width, destination.pixels.begin() + y * m_width);
+
+		{
+			std::lock_guard<std::mutex> guard{ m_lock };
+			m_queued.push_back(slot);
+		}
+		m_frameQueued.notify_one();
+	}
+	else
+		m_framesDropped++;
+
+	m_lastOverhead = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+	m_totalOverhead += m_lastOverhead;
+
+	return slot >= 0;
+}
+
+int FrameCapture::framesWritten()
+{
+	std::lock_guard<std::mutex> guard{ m_lock };
+	return m_framesWritten;
+}
+
+int FrameCapture::framesFailed()
+{
+	std::lock_guard<std::mutex> guard{ m_lock };
+	return m_framesFailed;
+}
+
+int FrameCapture::framesQueued()
+{
+	std::lock_guard<std::mutex> guard{ m_lock };
+	return static_cast<int>(m_queued.size());
+}
+
+void FrameCapture::writerLoop()
+{
+	std::unique_lock<std::mutex> guard{ m_lock };
+
+	while (true)
+	{
+		m_frameQueued.wait(guard, [this]() { return m_stopping || !m_queued.empty(); });
+
+		// Everything that was queued gets written before stopping
+		if (m_queued.empty())
+		{
+			if (m_settings.packed && !finishPackedFile(m_packed))
+				addError("Error writing capture file: " + m_settings.output);
+			return;
+		}
+
+		int slot{ m_queued.front() };
+		m_queued.pop_front();
+
+		// Writing can take a while, and the game shouldn't have to wait for it to queue another frame
+		guard.unlock();
+		bool succeeded{ write(m_slots[slot]) };
+		guard.lock();
+
+		m_free.push_back(slot);
+		if (succeeded)
+			m_framesWritten++;
+		else
+			m_framesFailed++;
+		m_slotFreed.notify_one();
+	}
+}
+
+bool FrameCapture::write(const Slot& slot)
+{
+	convertToRgb(slot.pixels.data(), m_width, m_height, m_image);
+
+	bool succeeded{};
+	std::string path{ m_settings.output };
+
+	if (m_settings.packed)
+		succeeded = writePackedFrame(m_packed, m_image);
+	else
+	{
+		path = frameImagePath(m_settings.output, slot.frame);
+		succeeded = writeFrameImage(path, m_image, m_width, m_height);
+	}
+
+	if (!succeeded)
+		addError("Error writing capture file: " + path);
+
+	return succeeded;
+}
+
+void FrameCapture::addError(const std::string& error)
+{
+	// Only the first few different ones are kept. A full disk would fail every frame after it, and the count of failed frames
+	// says how many
+	const size_t maxErrors{ 4 };
+
+	if (m_errors.size() < maxErrors && std::find(m_errors.begin(), m_errors.end(), error) == m_errors.end())
+		m_errors.push_back(error);
+}
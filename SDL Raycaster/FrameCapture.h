@@ -0,0 +1,108 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What happens to a frame when every slot is still waiting to be written
+enum class CapturePolicy
+{
+	DROP,	// Skip the frame. The game never waits on the disk, but the recording has gaps
+	BLOCK,	// Wait for the writer to free a slot. Every frame is recorded, but a slow disk slows the game down
+};
+
+struct CaptureSettings
+{
+	std::string output{};		// Prefix for the image files, or the name of the packed file
+	bool packed{ false };		// Write every frame into one file of raw RGB frames instead of one PPM image per frame
+	CapturePolicy policy{ CapturePolicy::DROP };
+	int slots{ 8 };				// Frames that can be waiting to be written at once. Each one is a full copy of the screen
+};
+
+// Records the frames the game renders without doing any file I/O on the game's thread. capture() only copies the screen into a
+// slot that was allocated up front and queues it, and a writer thread converts the queued frames and writes them out in the order
+// they were captured. The files are the same as the ones the batch renderer writes, so they can be turned into a video the same way
+//
+// Frames are numbered in the order they were captured, dropped ones included, so the image files of dropped frames are missing
+// from the sequence. The packed file just leaves them out
+class FrameCapture
+{
+private:
+	struct Slot
+	{
+		std::vector<uint32_t> pixels{};
+		int frame{};
+	};
+
+	int m_width{};
+	int m_height{};
+	CaptureSettings m_settings{};
+	bool m_open{ true };
+
+	std::vector<Slot> m_slots{};
+
+	// Shared with the writer thread. Only touched with m_lock held
+	std::mutex m_lock{};
+	std::condition_variable m_frameQueued{};
+	std::condition_variable m_slotFreed{};
+	std::vector<int> m_free{};		// Slots which can be filled
+	std::deque<int> m_queued{};		// Slots waiting to be written, oldest first
+	int m_framesWritten{ 0 };		// Only the frames which made it to the disk
+	int m_framesFailed{ 0 };
+	bool m_stopping{ false };
+
+	// Only touched by the game's thread
+	int m_nextFrame{ 0 };
+	int m_framesDropped{ 0 };
+	double m_lastOverhead{ 0.0 };
+	double m_totalOverhead{ 0.0 };
+
+	// Only touched by the writer thread, once it has started, until stop() has joined it. The writer doesn't print anything
+	// itself, so the errors are kept for stop() to report
+	std::ofstream m_packed{};
+	std::vector<char> m_image{};
+	std::vector<std::string> m_errors{};
+	std::thread m_writer{};
+
+	void writerLoop();
+	bool write(const Slot& slot);
+	void addError(const std::string& error);
+
+public:
+	// Allocates the slots and starts the writer thread. The packed file is opened here, so isOpen() says right away if it can't be
+	FrameCapture(int width, int height, const CaptureSettings& settings);
+
+	// Calls stop()
+	~FrameCapture();
+
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	bool isOpen() const { return m_open; }
+
+	// Queue a copy of a width by height screen. pitch is the length of a row of screen in pixels. Returns false if the frame was
+	// dropped
+	bool capture(const uint32_t* screen, int pitch);
+
+	// Write out every frame that is still queued, stop the writer thread, and print the errors it ran into. Returns false if any
+	// frame or the end of the packed file couldn't be written. Frames captured after this are dropped
+	bool stop();
+
+	// Seconds the last call to capture() took, including any time spent waiting for a slot, and the average over every call
+	double lastOverhead() const { return m_lastOverhead; }
+	double averageOverhead() const { return m_nextFrame > 0 ? m_totalOverhead / m_nextFrame : 0.0; }
+
+	int framesCaptured() const { return m_nextFrame - m_framesDropped; }
+	int framesDropped() const { return m_framesDropped; }
+	int framesWritten();
+	int framesFailed();
+	int framesQueued();
+};
+
+#endif
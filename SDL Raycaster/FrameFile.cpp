@@ -0,0 +1,53 @@
+#include "FrameFile.h"
+#include <cstdio>
+
+void convertToRgb(const uint32_t* pixels, int width, int height, std::vector<char>& image)
+{
+	image.resize(static_cast<size_t>(width) * height * 3);
+
+	// The screen is 0xRRGGBBAA, and the alpha is thrown away
+	for (int i{ 0 }; i < width * height; i++)
+	{
+		image[i * 3] = static_cast<char>(pixels[i] >> 24);
+		image[i * 3 + 1] = static_cast<char>(pixels[i] >> 16);
+		image[i * 3 + 2] = static_cast<char>(pixels[i] >> 8);
+	}
+}
+
+std::string frameImagePath(const std::string& prefix, int frame)
+{
+	char number[16]{};
+	snprintf(number, sizeof(number), "%06d", frame);
+
+	return prefix + "_" + number + ".ppm";
+}
+
+bool writeFrameImage(const std::string& path, const std::vector<char>& image, int width, int height)
+{
+	std::ofstream file{ path, std::ios::binary };
+	if (!file)
+		return false;
+
+	file << "P6\n" << width << ' ' << height << "\n255\n";
+	file.write(image.data(), image.size());
+
+	// Some of it might still be buffered, and only fail to write once it is flushed
+	file.close();
+	return !file.fail();
+}
+
+bool writePackedFrame(std::ofstream& file, const std::vector<char>& image)
+{
+	file.write(image.data(), image.size());
+
+	bool written{ static_cast<bool>(file) };
+	file.clear();
+
+	return written;
+}
+
+bool finishPackedFile(std::ofstream& file)
+{
+	file.close();
+	return !file.fail();
+}
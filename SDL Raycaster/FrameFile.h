@@ -0,0 +1,29 @@
+#ifndef FRAMEFILE_H
+#define FRAMEFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// The files frames are written to, by the batch renderer and by recording. Either one PPM image per frame, or one packed file of
+// raw RGB frames one after another. Both hold RGB, so the RGBA screen is converted first
+
+// Convert width * height pixels of an RGBA screen to RGB. image is resized to fit, which only allocates if it is the wrong size
+void convertToRgb(const uint32_t* pixels, int width, int height, std::vector<char>& image);
+
+// The name of the PPM image of a frame: prefix_000042.ppm
+std::string frameImagePath(const std::string& prefix, int frame);
+
+// Write an RGB frame as a PPM image. Returns false if the file couldn't be opened or anything in it couldn't be written
+bool writeFrameImage(const std::string& path, const std::vector<char>& image, int width, int height);
+
+// Write an RGB frame into a packed file wherever the file is at now. Returns false if it couldn't be written. The stream is cleared
+// again afterwards, since a failed write would leave it unusable and every frame after it would fail too. The frame isn't flushed,
+// so a write that only fails once it leaves the buffer shows up in finishPackedFile()
+bool writePackedFrame(std::ofstream& file, const std::vector<char>& image);
+
+// Flush and close a packed file. Returns false if the last of it couldn't be written
+bool finishPackedFile(std::ofstream& file);
+
+#endif
@@ -0,0 +1,227 @@
+#include "Lightmap.h"
+#include "Map.h"
+#include "SDL.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Add the light from a point light reaching a point on a surface to a packed light value. The light fades out linearly, the
+	// same way the player's light does, and is scaled by how directly the surface faces the light (normalX = normalY = 0 for
+	// the floor and ceiling, which are handled by the vertical distance instead)
+	uint32_t addLight(uint32_t value, const Light& light, float x, float y, float z, float normalX, float normalY)
+	{
+		float dx{ light.x - x };
+		float dy{ light.y - y };
+		float dz{ light.height - z };
+		float distance{ sqrtf(dx * dx + dy * dy + dz * dz) };
+
+		if (distance >= light.radius)
+			return value;
+
+		float strength{ light.intensity * (1.0f - distance / light.radius) };
+
+		// Walls which face away from the light get none of it
+		if (normalX != 0.0f || normalY != 0.0f)
+		{
+			float facing{ (dx * normalX + dy * normalY) / std::max(distance, 1.0f) };
+
+			if (facing <= 0.0f)
+				return value;
+
+			strength *= facing;
+		}
+
+		uint32_t result{ 0x00000000 };
+
+		// Add each channel and clamp it to 255
+		for (int shift{ 24 }; shift >= 8; shift -= 8)
+		{
+			uint32_t channel{ (value >> shift) & 0xFF };
+			channel += static_cast<uint32_t>(((light.color >> shift) & 0xFF) * strength);
+			result |= std::min(channel, 255u) << shift;
+		}
+
+		return result;
+	}
+}
+
+Lightmap::Lightmap(const Map& gridMap, uint32_t ambient)
+	: m_gridMap{ &gridMap }, m_gridWidth{ gridMap.width() }, m_gridHeight{ gridMap.height() }, m_gridSize{ gridMap.gridSize() }, m_ambient{ ambient & 0xFFFFFF00 },
+	m_isDirty(gridMap.width() * gridMap.height(), false)
+{
+	bake({});
+}
+
+bool Lightmap::isVisible(float fromX, float fromY, float toX, float toY) const
+{
+	float dx{ toX - fromX };
+	float dy{ toY - fromY };
+
+	// March along the line in steps of a quarter of a grid block, which is small enough not to skip over the corner of a wall
+	int steps{ static_cast<int>(sqrtf(dx * dx + dy * dy) / (m_gridSize * 0.25f)) + 1 };
+
+	// A door is lit from the middle of its own cell, which would be in its own shadow
+	int toGridX{ static_cast<int>(toX / m_gridSize) };
+	int toGridY{ static_cast<int>(toY / m_gridSize) };
+	bool endsInDoor{ toGridX >= 0 && toGridX < m_gridWidth && toGridY >= 0 && toGridY < m_gridHeight && m_gridMap->at(toGridX, toGridY) == Map::DOOR };
+
+	for (int i{ 1 }; i < steps; i++)
+	{
+		float t{ static_cast<float>(i) / steps };
+		int gridX{ static_cast<int>((fromX + dx * t) / m_gridSize) };
+		int gridY{ static_cast<int>((fromY + dy * t) / m_gridSize) };
+
+		if (endsInDoor && gridX == toGridX && gridY == toGridY)
+			continue;
+
+		if (m_gridMap->isSolid(gridX, gridY))
+			return false;
+	}
+
+	return true;
+}
+
+void Lightmap::accumulate(CellLight& cell, int gridX, int gridY, const Light& light, bool castShadows) const
+{
+	float size{ static_cast<float>(m_gridSize) };
+	float centerX{ (gridX + 0.5f) * size };
+	float centerY{ (gridY + 0.5f) * size };
+
+	if (m_gridMap->at(gridX, gridY) != Map::WALL)
+	{
+		// Open cells have a floor and a ceiling, lit from their center. So do doors, which the renderer lights with their floor
+		if (castShadows && !isVisible(light.x, light.y, centerX, centerY))
+			return;
+
+		cell.floor = addLight(cell.floor, light, centerX, centerY, 0.0f, 0.0f, 0.0f);
+		cell.ceiling = addLight(cell.ceiling, light, centerX, centerY, size, 0.0f, 0.0f);
+		return;
+	}
+
+	// Wall blocks have four faces, lit from just outside the middle of each one
+	const float halfSize{ size * 0.5f };
+	const float faceX[4]{ centerX, centerX, centerX + halfSize + 1.0f, centerX - halfSize - 1.0f };
+	const float faceY[4]{ centerY - halfSize - 1.0f, centerY + halfSize + 1.0f, centerY, centerY };
+	const float normalX[4]{ 0.0f, 0.0f, 1.0f, -1.0f };
+	const float normalY[4]{ -1.0f, 1.0f, 0.0f, 0.0f };
+
+	for (int face{ NORTH }; face <= WEST; face++)
+	{
+		if (castShadows && !isVisible(light.x, light.y, faceX[face], faceY[face]))
+			continue;
+
+		cell.wall[face] = addLight(cell.wall[face], light, faceX[face], faceY[face], halfSize, normalX[face], normalY[face]);
+	}
+}
+
+void Lightmap::bake(const std::vector<Light>& lights)
+{
+	m_lights = lights;
+
+	CellLight ambient{ m_ambient, m_ambient, { m_ambient, m_ambient, m_ambient, m_ambient } };
+	m_baked.assign(m_gridWidth * m_gridHeight, ambient);
+
+	for (int gridY{ 0 }; gridY < m_gridHeight; gridY++)
+	{
+		for (int gridX{ 0 }; gridX < m_gridWidth; gridX++)
+		{
+			for (const Light& light : lights)
+				accumulate(m_baked[gridY * m_gridWidth + gridX], gridX, gridY, light, true);
+		}
+	}
+
+	// Any dynamic lights are thrown away along with the old lighting
+	m_lit = m_baked;
+	m_dirtyCells.clear();
+	std::fill(m_isDirty.begin(), m_isDirty.end(), false);
+}
+
+void Lightmap::relight(int gridX, int gridY)
+{
+	relight(gridX, gridY, gridX, gridY);
+}
+
+void Lightmap::relight(int firstX, int firstY, int lastX, int lastY)
+{
+	// The range of cells to rebake, starting with just the changed ones
+	int changedFirstX{ firstX };
+	int changedFirstY{ firstY };
+	int changedLastX{ lastX };
+	int changedLastY{ lastY };
+
+	for (const Light& light : m_lights)
+	{
+		// Skip lights which can't reach any of the changed cells. The radius is padded by a block so that the cells' faces are
+		// included
+		float dx{ light.x - std::min(std::max(light.x, (changedFirstX + 0.5f) * m_gridSize), (changedLastX + 0.5f) * m_gridSize) };
+		float dy{ light.y - std::min(std::max(light.y, (changedFirstY + 0.5f) * m_gridSize), (changedLastY + 0.5f) * m_gridSize) };
+		if (sqrtf(dx * dx + dy * dy) > light.radius + m_gridSize)
+			continue;
+
+		firstX = std::min(firstX, static_cast<int>((light.x - light.radius - 1.0f) / m_gridSize));
+		firstY = std::min(firstY, static_cast<int>((light.y - light.radius - 1.0f) / m_gridSize));
+		lastX = std::max(lastX, static_cast<int>((light.x + light.radius + 1.0f) / m_gridSize));
+		lastY = std::max(lastY, static_cast<int>((light.y + light.radius + 1.0f) / m_gridSize));
+	}
+
+	firstX = std::max(firstX, 0);
+	firstY = std::max(firstY, 0);
+	lastX = std::min(lastX, m_gridWidth - 1);
+	lastY = std::min(lastY, m_gridHeight - 1);
+
+	CellLight ambient{ m_ambient, m_ambient, { m_ambient, m_ambient, m_ambient, m_ambient } };
+
+	for (int y{ firstY }; y <= lastY; y++)
+	{
+		for (int x{ firstX }; x <= lastX; x++)
+		{
+			int cell{ y * m_gridWidth + x };
+
+			m_baked[cell] = ambient;
+			for (const Light& light : m_lights)
+				accumulate(m_baked[cell], x, y, light, true);
+
+			// Cells with dynamic light on them are reset from m_baked when the dynamic lights are cleared
+			if (!m_isDirty[cell])
+				m_lit[cell] = m_baked[cell];
+		}
+	}
+}
+
+void Lightmap::clearDynamicLights()
+{
+	for (int cell : m_dirtyCells)
+	{
+		m_lit[cell] = m_baked[cell];
+		m_isDirty[cell] = false;
+	}
+
+	m_dirtyCells.clear();
+}
+
+void Lightmap::addDynamicLight(const Light& light)
+{
+	// Only the cells overlapping the light's radius can be affected by it. The wall faces are one pixel outside of their block,
+	// which is why the range is padded by one
+	int firstX{ std::max(static_cast<int>((light.x - light.radius - 1.0f) / m_gridSize), 0) };
+	int firstY{ std::max(static_cast<int>((light.y - light.radius - 1.0f) / m_gridSize), 0) };
+	int lastX{ std::min(static_cast<int>((light.x + light.radius + 1.0f) / m_gridSize), m_gridWidth - 1) };
+	int lastY{ std::min(static_cast<int>((light.y + light.radius + 1.0f) / m_gridSize), m_gridHeight - 1) };
+
+	for (int gridY{ firstY }; gridY <= lastY; gridY++)
+	{
+		for (int gridX{ firstX }; gridX <= lastX; gridX++)
+		{
+			int cell{ gridY * m_gridWidth + gridX };
+
+			if (!m_isDirty[cell])
+			{
+				m_isDirty[cell] = true;
+				m_dirtyCells.push_back(cell);
+			}
+
+			accumulate(m_lit[cell], gridX, gridY, light, false);
+		}
+	}
+}
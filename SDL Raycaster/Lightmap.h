@@ -0,0 +1,102 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include "SDL.h"
+#include <vector>
+
+class Map;
+
+// A point light. Colors are in the same RGBA format as the textures, with the alpha ignored
+struct Light
+{
+	float x{};
+	float y{};
+	float height{};				// Height of the light above the floor
+	float radius{};				// Distance at which the light has faded out completely
+	uint32_t color{ 0xFFFFFFFF };
+	float intensity{ 1.0f };	// Multiplier on the color, so lights can be brighter than white at their center
+};
+
+// Holds how much light reaches each floor cell, ceiling cell and wall face of the map. Static lights are baked once when the map
+// is loaded, so the render loop only has to look a value up. Dynamic lights are added on top every frame, and only touch the cells
+// within their radius
+class Lightmap
+{
+public:
+	// The four faces of a wall block, named by the direction they face
+	enum Face
+	{
+		NORTH,	// Faces up the map (towards -y)
+		SOUTH,	// Faces down the map (towards +y)
+		EAST,	// Faces towards +x
+		WEST,	// Faces towards -x
+	};
+
+private:
+	// Light values are packed like colors (0xRRGGBB00), where 255 in a channel means the texture is drawn at full brightness
+	struct CellLight
+	{
+		uint32_t floor{};
+		uint32_t ceiling{};
+		uint32_t wall[4]{};
+	};
+
+	const Map* m_gridMap{};
+	int m_gridWidth{};
+	int m_gridHeight{};
+	int m_gridSize{};
+	uint32_t m_ambient{};
+
+	std::vector<Light> m_lights{};		// The static lights from the last bake()
+	std::vector<CellLight> m_baked{};	// Ambient light plus the static lights
+	std::vector<CellLight> m_lit{};		// m_baked plus this frame's dynamic lights. This is what the renderer reads
+
+	std::vector<int> m_dirtyCells{};	// Cells a dynamic light has been added to since the last clearDynamicLights()
+	std::vector<bool> m_isDirty{};
+
+	// True if nothing solid (walls and closed doors) is between the two points. If the end point is in a door's cell, that cell
+	// doesn't count, so the door can still be lit even though it blocks light itself
+	bool isVisible(float fromX, float fromY, float toX, float toY) const;
+
+	// Add the light from one light to every surface of a cell. Static lights are shadowed by the walls, dynamic ones aren't
+	void accumulate(CellLight& cell, int gridX, int gridY, const Light& light, bool castShadows) const;
+
+public:
+	// The map is read again whenever cells are rebaked, so it has to outlive the lightmap. Its size can't change
+	Lightmap(const Map& gridMap, uint32_t ambient);
+
+	// Recalculate the static lighting from scratch. This is the slow part, so it should happen when the map is loaded
+	void bake(const std::vector<Light>& lights);
+
+	// Rebake the cells whose lighting could have changed because the cell (gridX, gridY) changed. That is every cell within the
+	// radius of a static light that reaches the changed cell, since the cell might now cast a shadow, or stop casting one. Doors
+	// cast shadows while they are closed, so they need this too when they start or stop blocking (see Map::changedCells())
+	void relight(int gridX, int gridY);
+
+	// The same for every cell from (firstX, firstY) to (lastX, lastY), inclusive. A lot of changed cells close together (like a
+	// chunk of a world being loaded) are relit much faster this way than one at a time, since each cell is only rebaked once
+	void relight(int firstX, int firstY, int lastX, int lastY);
+
+	// Remove the dynamic lights from last frame. Only the cells they touched are reset
+	void clearDynamicLights();
+
+	// Add a light for this frame only
+	void addDynamicLight(const Light& light);
+
+	// Light the renderer multiplies a texel by. gridX and gridY must be inside the map
+	uint32_t floor(int gridX, int gridY) const { return m_lit[gridY * m_gridWidth + gridX].floor; }
+	uint32_t ceiling(int gridX, int gridY) const { return m_lit[gridY * m_gridWidth + gridX].ceiling; }
+	uint32_t wall(int gridX, int gridY, Face face) const { return m_lit[gridY * m_gridWidth + gridX].wall[face]; }
+
+	// Multiply a color by a light value, one channel at a time. The + 1 makes a light of 255 leave the color unchanged
+	static uint32_t apply(uint32_t color, uint32_t light)
+	{
+		uint32_t red{ ((color >> 24) * ((light >> 24) + 1)) >> 8 };
+		uint32_t green{ (((color >> 16) & 0xFF) * (((light >> 16) & 0xFF) + 1)) >> 8 };
+		uint32_t blue{ (((color >> 8) & 0xFF) * (((light >> 8) & 0xFF) + 1)) >> 8 };
+
+		return (red << 24) | (green << 16) | (blue << 8) | 0x000000FF;
+	}
+};
+
+#endif
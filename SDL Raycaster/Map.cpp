@@ -0,0 +1,194 @@
+#include "Map.h"
+#include "SDL.h"
+#include <algorithm>
+
+namespace
+{
+	const float doorSpeed{ 1.5f };			// Fraction of a door's width it moves per second
+	const float doorPassableOpen{ 0.8f };	// How open a door has to be before it can be walked through
+}
+
+Map::Map(const std::string& cells, int width, int height, int gridSize)
+	: m_cells{ cells }, m_textureIds(cells.size(), 0), m_doorIds(cells.size(), -1), m_width{ width }, m_height{ height }, m_gridSize{ gridSize }
+{
+	for (int gridY{ 0 }; gridY < m_height; gridY++)
+	{
+		for (int gridX{ 0 }; gridX < m_width; gridX++)
+		{
+			if (at(gridX, gridY) == DOOR)
+			{
+				m_textureIds[gridY * m_width + gridX] = DOOR_TEXTURE;
+				addDoor(gridX, gridY);
+			}
+		}
+	}
+}
+
+void Map::addDoor(int gridX, int gridY)
+{
+	Door door{};
+	door.gridX = gridX;
+	door.gridY = gridY;
+
+	// A door with walls to the left and right of it runs between them, along the x-axis
+	door.alongX = gridX > 0 && gridX < m_width - 1 && at(gridX - 1, gridY) == WALL && at(gridX + 1, gridY) == WALL;
+
+	m_doorIds[gridY * m_width + gridX] = static_cast<int>(m_doors.size());
+	m_doors.push_back(door);
+}
+
+void Map::removeDoor(int gridX, int gridY)
+{
+	int id{ m_doorIds[gridY * m_width + gridX] };
+	int last{ static_cast<int>(m_doors.size()) - 1 };
+
+	m_movingDoors.erase(std::remove(m_movingDoors.begin(), m_movingDoors.end(), id), m_movingDoors.end());
+
+	// Move the last door into the removed door's place so nothing else has to shift
+	if (id != last)
+	{
+		m_doors[id] = m_doors[last];
+		m_doorIds[m_doors[id].gridY * m_width + m_doors[id].gridX] = id;
+		std::replace(m_movingDoors.begin(), m_movingDoors.end(), last, id);
+	}
+
+	m_doors.pop_back();
+	m_doorIds[gridY * m_width + gridX] = -1;
+}
+
+const Map::Door* Map::door(int gridX, int gridY) const
+{
+	int id{ m_doorIds[gridY * m_width + gridX] };
+	return id < 0 ? nullptr : &m_doors[id];
+}
+
+bool Map::hitsDoor(int gridX, int gridY, bool crossingHorizontalLine, float& x, float& y, float dx, float dy, int& slide) const
+{
+	const Door* cellDoor{ door(gridX, gridY) };
+
+	// Rays crossing the other set of grid lines can only reach the door through its ends, which are up against walls
+	if (cellDoor->alongX != crossingHorizontalLine)
+		return false;
+
+	float middleX{ x + dx * 0.5f };
+	float middleY{ y + dy * 0.5f };
+
+	// How far along the door the ray hits it. If that is outside of the cell, the ray leaves through the side of the cell, into
+	// the wall the door is set in
+	int along{ static_cast<int>(crossingHorizontalLine ? middleX : middleY) - (crossingHorizontalLine ? gridX : gridY) * m_gridSize };
+	if (along < 0 || along >= m_gridSize)
+		return false;
+
+	// The door slides towards its start, so the open part is at the beginning of the cell
+	int openPixels{ static_cast<int>(cellDoor->open * m_gridSize) };
+	if (along < openPixels)
+		return false;
+
+	x = middleX;
+	y = middleY;
+	slide = openPixels;
+
+	return true;
+}
+
+bool Map::isSolid(int gridX, int gridY) const
+{
+	if (gridX < 0 || gridX >= m_width || gridY < 0 || gridY >= m_height)
+		return true;
+
+	char cell{ at(gridX, gridY) };
+
+	if (cell == EMPTY)
+		return false;
+
+	if (cell == DOOR)
+		return door(gridX, gridY)->open < doorPassableOpen;
+
+	return true;
+}
+
+void Map::setCell(int gridX, int gridY, char cell, uint8_t textureId)
+{
+	int i{ gridY * m_width + gridX };
+
+	if (m_cells[i] == DOOR)
+		removeDoor(gridX, gridY);
+
+	m_cells[i] = cell;
+	m_textureIds[i] = textureId;
+
+	if (cell == DOOR)
+		addDoor(gridX, gridY);
+
+	m_changedCells.push_back(i);
+}
+
+void Map::toggleDoor(int gridX, int gridY)
+{
+	if (gridX < 0 || gridX >= m_width || gridY < 0 || gridY >= m_height)
+		return;
+
+	int id{ m_doorIds[gridY * m_width + gridX] };
+	if (id < 0)
+		return;
+
+	Door& door{ m_doors[id] };
+	door.target = door.target > 0.5f ? 0.0f : 1.0f;
+
+	if (std::find(m_movingDoors.begin(), m_movingDoors.end(), id) == m_movingDoors.end())
+		m_movingDoors.push_back(id);
+}
+
+void Map::setDoorState(int gridX, int gridY, float open, float target)
+{
+	if (gridX < 0 || gridX >= m_width || gridY < 0 || gridY >= m_height)
+		return;
+
+	int id{ m_doorIds[gridY * m_width + gridX] };
+	if (id < 0)
+		return;
+
+	Door& door{ m_doors[id] };
+	bool wasBlocking{ door.open < doorPassableOpen };
+
+	door.open = open;
+	door.target = target;
+
+	if ((door.open < doorPassableOpen) != wasBlocking)
+		m_changedCells.push_back(gridY * m_width + gridX);
+
+	bool moving{ std::find(m_movingDoors.begin(), m_movingDoors.end(), id) != m_movingDoors.end() };
+
+	if (open != target && !moving)
+		m_movingDoors.push_back(id);
+	else if (open == target && moving)
+		m_movingDoors.erase(std::find(m_movingDoors.begin(), m_movingDoors.end(), id));
+}
+
+void Map::update(float deltaTime)
+{
+	for (int i{ 0 }; i < static_cast<int>(m_movingDoors.size());)
+	{
+		Door& door{ m_doors[m_movingDoors[i]] };
+		bool wasBlocking{ door.open < doorPassableOpen };
+
+		if (door.open < door.target)
+			door.open = std::min(door.open + doorSpeed * deltaTime, door.target);
+		else
+			door.open = std::max(door.open - doorSpeed * deltaTime, door.target);
+
+		// A door stops or starts blocking part way through moving. Whatever was built from the map, like the shadows in the
+		// lightmap, has to be updated then, the same as if the cell had been changed
+		if ((door.open < doorPassableOpen) != wasBlocking)
+			m_changedCells.push_back(door.gridY * m_width + door.gridX);
+
+		// Once a door stops, it is taken off of the list
+		if (door.open == door.target)
+		{
+			m_movingDoors[i] = m_movingDoors.back();
+			m_movingDoors.pop_back();
+		}
+		else
+			i++;
+	}
+}
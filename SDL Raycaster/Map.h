@@ -0,0 +1,95 @@
+#ifndef MAP_H
+#define MAP_H
+
+#include "SDL.h"
+#include <string>
+#include <vector>
+
+// The grid the world is made of. Cells are stored as characters in one string, indexed by gridY * width + gridX, along with the
+// texture each cell uses and the state of any doors. Cells can be changed while the game is running, and the cells which changed
+// are remembered so that anything built from the map (like the lightmap) only has to update those cells
+class Map
+{
+public:
+	static const char EMPTY{ '-' };
+	static const char WALL{ '#' };
+	static const char DOOR{ 'D' };
+
+	// A sliding door. It is a thin wall through the middle of its cell, which slides sideways into the wall next to it
+	struct Door
+	{
+		int gridX{};
+		int gridY{};
+		bool alongX{};		// True if the door runs along the x-axis (it has walls to its left and right), false if it runs along y
+		float open{};		// 0 is closed, 1 is fully open
+		float target{};		// What open is moving towards
+	};
+
+private:
+	std::string m_cells{};
+	std::vector<uint8_t> m_textureIds{};
+	std::vector<int> m_doorIds{};		// Index into m_doors for door cells, -1 for everything else
+	std::vector<Door> m_doors{};
+	std::vector<int> m_movingDoors{};	// Doors which haven't reached their target yet. Only these are updated each frame
+	std::vector<int> m_changedCells{};	// Cells which have changed since the last clearChangedCells()
+
+	int m_width{};
+	int m_height{};
+	int m_gridSize{};
+
+	void addDoor(int gridX, int gridY);
+	void removeDoor(int gridX, int gridY);
+
+public:
+	static const int DOOR_TEXTURE{ 1 };	// Texture ID doors get when the map is loaded. Everything else gets texture 0
+
+	Map(const std::string& cells, int width, int height, int gridSize);
+
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+	int gridSize() const { return m_gridSize; }
+
+	const std::string& cells() const { return m_cells; }
+	char operator[](int i) const { return m_cells[i]; }
+	char at(int gridX, int gridY) const { return m_cells[gridY * m_width + gridX]; }
+
+	uint8_t textureId(int gridX, int gridY) const { return m_textureIds[gridY * m_width + gridX]; }
+
+	// The door in a cell, or nullptr if the cell isn't a door
+	const Door* door(int gridX, int gridY) const;
+
+	// Every door in the map, in no particular order
+	const std::vector<Door>& doors() const { return m_doors; }
+
+	// Set how far open a door is and what it is moving towards, like when putting back a door that was saved. Does nothing if the
+	// cell isn't a door
+	void setDoorState(int gridX, int gridY, float open, float target);
+
+	// True if the cell blocks movement: walls, doors which aren't open far enough to walk through, and anything outside the map
+	bool isSolid(int gridX, int gridY) const;
+
+	// A ray which crosses a grid line into a door cell at (x, y) hits the door halfway through the cell, if the door runs parallel to
+	// that grid line. (dx, dy) is how far the ray goes from one of those grid lines to the next. Returns true if the ray hits the
+	// closed part of the door, in which case (x, y) is moved to the point it hit and slide is set to how far (in pixels) the door has
+	// slid open. The renderer and the ray queries both use this, so they agree on where a door is. Only call it for door cells
+	bool hitsDoor(int gridX, int gridY, bool crossingHorizontalLine, float& x, float& y, float dx, float dy, int& slide) const;
+
+	// Change one cell. Only that cell's bookkeeping is touched, so this is cheap enough to do during the game
+	void setCell(int gridX, int gridY, char cell, uint8_t textureId);
+
+	// Start opening a closed door, or closing an open one. Does nothing if the cell isn't a door
+	void toggleDoor(int gridX, int gridY);
+
+	// Move the doors which are opening or closing
+	void update(float deltaTime);
+
+	// True while any door is opening or closing
+	bool doorsMoving() const { return !m_movingDoors.empty(); }
+
+	// The indices of the cells changed by setCell() since the list was last cleared, along with doors which have started or stopped
+	// blocking (see isSolid())
+	const std::vector<int>& changedCells() const { return m_changedCells; }
+	void clearChangedCells() { m_changedCells.clear(); }
+};
+
+#endif
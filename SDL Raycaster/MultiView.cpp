@@ -0,0 +1,128 @@
+#include "MultiView.h"
+#include "Angles.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Columns per strip. Small enough to spread a few small views over the threads, big enough that taking a strip is rare
+	const int stripWidth{ 32 };
+}
+
+MultiView::MultiView(const RenderContext& shared, ColumnRenderer renderColumns, int threads)
+	: m_shared{ &shared }, m_renderColumns{ renderColumns }, m_pool{ threads }
+{
+
+}
+
+int MultiView::addView(const View& view, const RenderContext& context)
+{
+	int index{ viewCount() };
+
+	m_views.push_back(view);
+	m_contexts.push_back(context);
+	m_columns.emplace_back();
+	m_pixels.emplace_back();
+
+	if (index != m_mainView)
+		m_columns.back().resize(view.width);
+
+	if (index > 0)
+		m_pixels.back().resize(view.width * view.height);
+
+	for (int first{ 0 }; first < view.width; first += stripWidth)
+		m_strips.push_back(Strip{ index, first, std::min(first + stripWidth, view.width) });
+
+	return index;
+}
+
+int MultiView::addView(int x, int y, int width, int height, float fov)
+{
+	View view{};
+	view.x = x;
+	view.y = y;
+	view.width = width;
+	view.height = height;
+	view.fov = fov;
+	view.camera.height = m_shared->gridSize / 2;
+	view.camera.projectionPlaneCenter = height / 2;
+
+	// Everything that stays the same from frame to frame is copied from the shared context once, here
+	RenderContext context{ *m_shared };
+	context.debug = nullptr;
+	context.width = width;
+	context.height = height;
+
+	// The rays are spread out to fill the view's width with its field of view. The distance used for the height of the walls
+	// keeps the same ratio to that as in the shared context, so the view isn't squashed or stretched compared to the main one
+	context.adjustedDistanceToProjectionPlane = (width / 2) / fabsf(tanf(radians(fov / 2.0f)));
+	context.distanceToProjectionPlane = static_cast<int>(m_shared->distanceToProjectionPlane * context.adjustedDistanceToProjectionPlane / m_shared->adjustedDistanceToProjectionPlane);
+
+	return addView(view, context);
+}
+
+int MultiView::addMainView()
+{
+	View view{};
+	view.width = m_shared->width;
+	view.height = m_shared->height;
+	view.fov = 2.0f * degrees(atanf((view.width / 2) / m_shared->adjustedDistanceToProjectionPlane));
+	view.camera = m_shared->camera;
+
+	RenderContext context{ *m_shared };
+	context.debug = nullptr;
+
+	m_mainView = viewCount();
+	return addView(view, context);
+}
+
+void MultiView::render(uint32_t* target, int pitch)
+{
+	// Only the camera and the fog change from frame to frame. Where the views are drawn is also set here, since the target and the
+	// column buffers are only known to stay put until this returns
+	for (int i{ 0 }; i < viewCount(); i++)
+	{
+		const View& view{ m_views[i] };
+		RenderContext& context{ m_contexts[i] };
+
+		context.camera = view.camera;
+		context.viewDistance = m_shared->viewDistance;
+		context.fogStart = m_shared->fogStart;
+		context.columns = i == m_mainView ? m_shared->columns : &m_columns[i];
+
+		if (i == 0)
+		{
+			context.screen = target + view.y * pitch + view.x;
+			context.pitch = pitch;
+		}
+		else
+		{
+			context.screen = m_pixels[i].data();
+			context.pitch = view.width;
+		}
+
+		// The kernel skips floor and ceiling pixels which land outside of the map, so clear the rectangle first. The main view is
+		// left alone, the same as when it is rendered on its own
+		if (i != m_mainView)
+			for (int row{ 0 }; row < view.height; row++)
+				std::fill(context.screen + row * context.pitch, context.screen + row * context.pitch + view.width, 0);
+	}
+
+	// Every thread keeps taking the next strip until there are none left
+	m_pool.run(static_cast<int>(m_strips.size()), [this](int i)
+	{
+		const Strip& strip{ m_strips[i] };
+		m_renderColumns(m_contexts[strip.view], strip.firstColumn, strip.lastColumn);
+	});
+
+	// The views after the first go on top of it, in order
+	for (int i{ 1 }; i < viewCount(); i++)
+	{
+		const View& view{ m_views[i] };
+		const uint32_t* pixels{ m_pixels[i].data() };
+
+		for (int row{ 0 }; row < view.height; row++)
+			std::copy(pixels + row * view.width, pixels + (row + 1) * view.width, target + (view.y + row) * pitch + view.x);
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef MULTIVIEW_H
+#define MULTIVIEW_H
+
+#include "Renderer.h"
+#include "WorkerPool.h"
+#include <vector>
+
+// One camera drawn into a rectangle of a bigger buffer (a split-screen half, a rear-view mirror, a security camera...)
+struct View
+{
+	Camera camera{};
+	int x{};		// Top left corner of the view in the buffer
+	int y{};
+	int width{};
+	int height{};
+	float fov{};	// Horizontal field of view in degrees
+};
+
+// Renders several views per frame. The map, textures and lights are shared by every view and only read, so the only things each
+// view has of its own are its camera, its projection and its column buffer. The views are split into strips of columns, and the
+// worker threads take strips from all of the views, so a small view doesn't leave threads waiting while a big one finishes. The
+// threads are started once and sleep between frames. Views are drawn in the order they were added, later ones on top. The first
+// view is rendered straight into the target, and the rest into pixels of their own which are copied over it once every strip is
+// done, so views that overlap can still be rendered at the same time
+class MultiView
+{
+private:
+	const RenderContext* m_shared{};
+	ColumnRenderer m_renderColumns{};
+	WorkerPool m_pool;
+
+	std::vector<View> m_views{};
+	std::vector<RenderContext> m_contexts{};		// One per view, set up by addView(). Only the per-frame fields change after that
+	std::vector<ColumnBuffer> m_columns{};			// Empty for the main view, which uses the shared context's
+	std::vector<std::vector<uint32_t>> m_pixels{};	// What each view after the first is rendered into
+	int m_mainView{ -1 };
+
+	// A strip of columns of one view, which is what the worker threads are handed
+	struct Strip
+	{
+		int view{};
+		int firstColumn{};
+		int lastColumn{};
+	};
+	std::vector<Strip> m_strips{};
+
+	int addView(const View& view, const RenderContext& context);
+
+public:
+	// shared holds the map, textures, lights and fog, and has to outlive the MultiView. The views point to the same map, textures
+	// and lights, so changes to those show up in the views, and the fog distances are read again every frame. renderColumns should
+	// be a kernel without debug capture, since the views don't fill one in. threads is the number of threads that render, counting
+	// the one that calls render(), or 0 for one per core
+	MultiView(const RenderContext& shared, ColumnRenderer renderColumns, int threads = 0);
+
+	// Add a view and return its index. Its camera starts out with the projection plane centered in the view
+	int addView(int x, int y, int width, int height, float fov);
+
+	// Add a view which covers the shared context's whole screen with its projection and column buffer, so it renders the same as
+	// the shared context would on its own, and return its index. It should be added first, so the other views go on top of it
+	int addMainView();
+
+	View& view(int index) { return m_views[index]; }
+	int viewCount() const { return static_cast<int>(m_views.size()); }
+
+	// The column buffer the last render() filled in for a view
+	const ColumnBuffer& columns(int index) const { return index == m_mainView ? *m_shared->columns : m_columns[index]; }
+
+	// Render every view into target. The rectangles of the views other than the main one are cleared first. pitch is the length
+	// of a row of target in pixels
+	void render(uint32_t* target, int pitch);
+};
+
+#endif
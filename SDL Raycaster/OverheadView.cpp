@@ -0,0 +1,169 @@
+#include "OverheadView.h"
+#include "Angles.h"
+#include "Map.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// In RGBA format, like the rest of the pixels
+	const uint32_t background{ 0x000000FF };
+	const uint32_t white{ 0xFFFFFFFF };
+	const uint32_t red{ 0xFF0000FF };
+	const uint32_t green{ 0x00FF00FF };
+}
+
+OverheadView::OverheadView(const Map& gridMap, int size)
+	: m_map{ gridMap }, m_size{ size }, m_cellWidth{ size / gridMap.width() }, m_cellHeight{ size / gridMap.height() },
+	m_scaleX{ static_cast<float>(size) / (gridMap.width() * gridMap.gridSize()) }, m_scaleY{ static_cast<float>(size) / (gridMap.height() * gridMap.gridSize()) },
+	m_mapLayer(size * size, background), m_pixels(size * size, background)
+{
+	for (int gridY{ 0 }; gridY < m_map.height(); gridY++)
+	{
+		for (int gridX{ 0 }; gridX < m_map.width(); gridX++)
+			redrawCell(gridX, gridY);
+	}
+}
+
+void OverheadView::redrawCell(int gridX, int gridY)
+{
+	int left{ gridX * m_cellWidth };
+	int top{ gridY * m_cellHeight };
+
+	// The outline is drawn inside of the block, so blocks never share pixels and one can be cleared without touching its neighbors
+	for (int y{ top }; y < top + m_cellHeight; y++)
+		std::fill(m_mapLayer.begin() + y * m_size + left, m_mapLayer.begin() + y * m_size + left + m_cellWidth, background);
+
+	if (m_map.at(gridX, gridY) != Map::EMPTY)
+		drawRect(left, top, m_cellWidth, m_cellHeight, white, m_mapLayer);
+}
+
+void OverheadView::redrawCells(int firstX, int firstY, int lastX, int lastY)
+{
+	for (int gridY{ std::max(firstY, 0) }; gridY <= std::min(lastY, m_map.height() - 1); gridY++)
+	{
+		for (int gridX{ std::max(firstX, 0) }; gridX <= std::min(lastX, m_map.width() - 1); gridX++)
+			redrawCell(gridX, gridY);
+	}
+}
+
+void OverheadView::draw(const Camera& camera, float fov, const DebugCapture& debug, float moveX, float moveY)
+{
+	// Start from the map layer instead of drawing every block again
+	std::copy(m_mapLayer.begin(), m_mapLayer.end(), m_pixels.begin());
+
+	// Position of the player in the view
+	float playerX{ camera.x * m_scaleX };
+	float playerY{ camera.y * m_scaleY };
+
+	// The horizontal and vertical intersections, then the rays which are used to render the scene on top of them
+	for (const point& p : debug.aPoints)
+		drawLine(playerX, playerY, p.x * m_scaleX, p.y * m_scaleY, white);
+
+	for (const point& p : debug.bPoints)
+		drawLine(playerX, playerY, p.x * m_scaleX, p.y * m_scaleY, white);
+
+	for (const point& p : debug.actualPoints)
+		drawLine(playerX, playerY, p.x * m_scaleX, p.y * m_scaleY, red);
+
+	// The points where the floor is sampled. Drawing them used to be too slow, but they are only a pixel each here
+	for (const point& p : debug.floorPoints)
+		drawPixel(static_cast<int>(p.x * m_scaleX), static_cast<int>(p.y * m_scaleY), red);
+
+	// The player, and the direction they are moving
+	drawRect(static_cast<int>(playerX) - 5, static_cast<int>(playerY) - 5, 10, 10, white, m_pixels);
+	drawLine(playerX, playerY, playerX + moveX, playerY + moveY, white);
+
+	// The edges of the field of view
+	float leftEdge{ radians(camera.theta - fov / 2.0f) };
+	float rightEdge{ radians(camera.theta + fov / 2.0f) };
+	drawLine(playerX, playerY, playerX + 100.0f * cosf(leftEdge), playerY - 100.0f * sinf(leftEdge), green);
+	drawLine(playerX, playerY, playerX + 100.0f * cosf(rightEdge), playerY - 100.0f * sinf(rightEdge), green);
+}
+
+void OverheadView::drawPixel(int x, int y, uint32_t color)
+{
+	if (x >= 0 && x < m_size && y >= 0 && y < m_size)
+		m_pixels[y * m_size + x] = color;
+}
+
+void OverheadView::drawLine(float x0, float y0, float x1, float y1, uint32_t color)
+{
+	// Rays which leave the map end very far away, so clip the line to the view first (Liang-Barsky) instead of stepping along all
+	// of it
+	if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1))
+		return;
+
+	float dx{ x1 - x0 };
+	float dy{ y1 - y0 };
+	float enter{ 0.0f };
+	float exit{ 1.0f };
+	float edge{ static_cast<float>(m_size - 1) };
+
+	// For each edge of the view: how fast the line moves towards the outside of it, and how far inside of it the start is
+	float towardsOutside[4]{ -dx, dx, -dy, dy };
+	float inside[4]{ x0, edge - x0, y0, edge - y0 };
+
+	for (int i{ 0 }; i < 4; i++)
+	{
+		if (towardsOutside[i] == 0.0f)
+		{
+			// Parallel to this edge, and on the wrong side of it
+			if (inside[i] < 0.0f)
+				return;
+			continue;
+		}
+
+		float t{ inside[i] / towardsOutside[i] };
+		if (towardsOutside[i] < 0.0f)
+			enter = std::max(enter, t);
+		else
+			exit = std::min(exit, t);
+	}
+
+	if (enter > exit)
+		return;
+
+	// Step one pixel at a time along the longer axis
+	float startX{ x0 + dx * enter };
+	float startY{ y0 + dy * enter };
+	float endX{ x0 + dx * exit };
+	float endY{ y0 + dy * exit };
+
+	int steps{ static_cast<int>(std::max(fabsf(endX - startX), fabsf(endY - startY))) };
+	float stepX{ steps > 0 ? (endX - startX) / steps : 0.0f };
+	float stepY{ steps > 0 ? (endY - startY) / steps : 0.0f };
+
+	for (int i{ 0 }; i <= steps; i++)
+	{
+		// The clipping can be off by a tiny bit, so the pixel is still checked against the view
+		drawPixel(static_cast<int>(startX + 0.5f), static_cast<int>(startY + 0.5f), color);
+		startX += stepX;
+		startY += stepY;
+	}
+}
+
+void OverheadView::drawRect(int x, int y, int w, int h, uint32_t color, std::vector<uint32_t>& pixels)
+{
+	// Outline only, like SDL_RenderDrawRect()
+	int left{ std::max(x, 0) };
+	int right{ std::min(x + w - 1, m_size - 1) };
+	int top{ std::max(y, 0) };
+	int bottom{ std::min(y + h - 1, m_size - 1) };
+
+	for (int i{ left }; i <= right; i++)
+	{
+		if (y >= 0 && y < m_size)
+			pixels[y * m_size + i] = color;
+		if (y + h - 1 >= 0 && y + h - 1 < m_size)
+			pixels[(y + h - 1) * m_size + i] = color;
+	}
+
+	for (int i{ top }; i <= bottom; i++)
+	{
+		if (x >= 0 && x < m_size)
+			pixels[i * m_size + x] = color;
+		if (x + w - 1 >= 0 && x + w - 1 < m_size)
+			pixels[i * m_size + x + w - 1] = color;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef OVERHEADVIEW_H
+#define OVERHEADVIEW_H
+
+#include "SDL.h"
+#include "Map.h"
+#include "Renderer.h"
+#include <vector>
+
+// The DEBUG view of the map from above, drawn into a pixel array on the CPU the same way the scene is, so it can be sent to the GPU
+// as one streaming texture instead of thousands of draw calls. The outlines of the blocks don't change from frame to frame, so
+// they are drawn once into their own layer, and each frame starts from a copy of it before the rays and the player are drawn on top
+class OverheadView
+{
+private:
+	const Map& m_map;
+	int m_size{};				// The view is square, m_size pixels on each side
+	int m_cellWidth{};			// Size of one grid block in the view
+	int m_cellHeight{};
+	float m_scaleX{};			// View pixels per map pixel
+	float m_scaleY{};
+
+	std::vector<uint32_t> m_mapLayer{};	// Just the block outlines
+	std::vector<uint32_t> m_pixels{};	// The finished view
+
+	void drawPixel(int x, int y, uint32_t color);
+	void drawLine(float x0, float y0, float x1, float y1, uint32_t color);
+	void drawRect(int x, int y, int w, int h, uint32_t color, std::vector<uint32_t>& pixels);
+
+public:
+	OverheadView(const Map& gridMap, int size);
+
+	// Redraw one block of the map layer. Call it for the cells in Map::changedCells() so the layer stays up to date
+	void redrawCell(int gridX, int gridY);
+
+	// Redraw every block from (firstX, firstY) to (lastX, lastY), inclusive
+	void redrawCells(int firstX, int firstY, int lastX, int lastY);
+
+	// Draw the view for this frame: the map layer, the rays in debug (and the floor points, if there are any), the player, and
+	// the edges of the field of view. moveX and moveY is the player's movement, which is drawn as a line from the player
+	void draw(const Camera& camera, float fov, const DebugCapture& debug, float moveX, float moveY);
+
+	const uint32_t* pixels() const { return m_pixels.data(); }
+	int size() const { return m_size; }
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "Palette.h"
+#include "Texture.h"
+#include "SDL.h"
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+
+namespace
+{
+	// A distinct color and how many pixels use it
+	struct ColorCount
+	{
+		uint32_t color{};
+		int count{};
+	};
+
+	inline int channel(uint32_t color, int which)
+	{
+		return (color >> (24 - which * 8)) & 0xFF;
+	}
+
+	// A box of colors in the median cut. Colors are stored in one array, and each box owns a range of it
+	struct Box
+	{
+		int first{};
+		int last{};			// One past the end
+		int widestChannel{};
+		int range{};		// Range of the widest channel. Boxes with the largest range are split first
+	};
+
+	void measure(Box& box, const std::vector<ColorCount>& colors)
+	{
+		int low[3]{ 255, 255, 255 };
+		int high[3]{ 0, 0, 0 };
+
+		for (int i{ box.first }; i < box.last; i++)
+		{
+			for (int c{ 0 }; c < 3; c++)
+			{
+				low[c] = std::min(low[c], channel(colors[i].color, c));
+				high[c] = std::max(high[c], channel(colors[i].color, c));
+			}
+		}
+
+		box.widestChannel = 0;
+		for (int c{ 1 }; c < 3; c++)
+		{
+			if (high[c] - low[c] > high[box.widestChannel] - low[box.widestChannel])
+				box.widestChannel = c;
+		}
+
+		box.range = high[box.widestChannel] - low[box.widestChannel];
+	}
+}
+
+void Palette::build(const std::vector<const Texture*>& textures)
+{
+	// Count how often each color is used
+	std::unordered_map<uint32_t, int> counts{};
+	for (const Texture* texture : textures)
+	{
+		for (int i{ 0 }; i < texture->m_width * texture->m_height; i++)
+			counts[(*texture)[i] | 0x000000FF]++;
+	}
+
+	std::vector<ColorCount> colors{};
+	colors.reserve(counts.size());
+	for (const auto& count : counts)
+		colors.push_back(ColorCount{ count.first, count.second });
+
+	m_colors.clear();
+
+	// If there are few enough colors, every one of them gets an entry
+	if (static_cast<int>(colors.size()) <= MAX_COLORS)
+	{
+		for (const ColorCount& color : colors)
+			m_colors.push_back(color.color);
+		return;
+	}
+
+	// Otherwise keep splitting the box with the widest range of colors in half, until there is a box for each palette entry
+	std::vector<Box> boxes{ Box{ 0, static_cast<int>(colors.size()) } };
+	measure(boxes[0], colors);
+
+	while (static_cast<int>(boxes.size()) < MAX_COLORS)
+	{
+		auto widest{ std::max_element(boxes.begin(), boxes.end(), [](const Box& a, const Box& b) { return a.range < b.range; }) };
+
+		// Every box is a single color
+		if (widest->range == 0)
+			break;
+
+		Box box{ *widest };
+		int which{ box.widestChannel };
+		std::sort(colors.begin() + box.first, colors.begin() + box.last,
+			[which](const ColorCount& a, const ColorCount& b) { return channel(a.color, which) < channel(b.color, which); });
+
+		// Split where half of the pixels (not half of the distinct colors) are on each side
+		int total{ 0 };
+		for (int i{ box.first }; i < box.last; i++)
+			total += colors[i].count;
+
+		int split{ box.first + 1 };
+		for (int seen{ colors[box.first].count }; split < box.last - 1 && seen < total / 2; split++)
+			seen += colors[split].count;
+
+		Box lower{ box.first, split };
+		Box upper{ split, box.last };
+		measure(lower, colors);
+		measure(upper, colors);
+
+		*widest = lower;
+		boxes.push_back(upper);
+	}
+
+	// Each palette entry is the average of the colors in its box, weighted by how often they are used
+	for (const Box& box : boxes)
+	{
+		double sum[3]{};
+		double total{};
+
+		for (int i{ box.first }; i < box.last; i++)
+		{
+			for (int c{ 0 }; c < 3; c++)
+				sum[c] += static_cast<double>(channel(colors[i].color, c)) * colors[i].count;
+			total += colors[i].count;
+		}
+
+		uint32_t color{ 0x000000FF };
+		for (int c{ 0 }; c < 3; c++)
+			color |= static_cast<uint32_t>(sum[c] / total + 0.5) << (24 - c * 8);
+
+		m_colors.push_back(color);
+	}
+}
+
+uint8_t Palette::nearest(uint32_t color) const
+{
+	int best{ 0 };
+	int bestDistance{ INT_MAX };
+
+	for (int i{ 0 }; i < size(); i++)
+	{
+		int distance{ 0 };
+		for (int c{ 0 }; c < 3; c++)
+		{
+			int difference{ channel(color, c) - channel(m_colors[i], c) };
+			distance += difference * difference;
+		}
+
+		if (distance < bestDistance)
+		{
+			best = i;
+			bestDistance = distance;
+		}
+	}
+
+	return static_cast<uint8_t>(best);
+}
+
+void Colormap::build(const Palette& palette)
+{
+	m_table.assign(LEVELS * Palette::MAX_COLORS, 0x000000FF);
+
+	for (int level{ 0 }; level < LEVELS; level++)
+	{
+		// The top level leaves the colors unchanged, and the bottom one is black
+		float brightness{ static_cast<float>(level) / (LEVELS - 1) };
+
+		for (int i{ 0 }; i < palette.size(); i++)
+		{
+			uint32_t color{ palette[i] };
+			uint32_t shaded{ 0x000000FF };
+
+			for (int c{ 0 }; c < 3; c++)
+				shaded |= static_cast<uint32_t>(channel(color, c) * brightness) << (24 - c * 8);
+
+			m_table[(level << 8) | i] = shaded;
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "SDL.h"
+#include <algorithm>
+#include <vector>
+
+class Texture;
+
+// Up to 256 colors shared by every indexed texture
+class Palette
+{
+private:
+	std::vector<uint32_t> m_colors{};
+
+public:
+	static const int MAX_COLORS{ 256 };
+
+	Palette() = default;
+
+	// Pick the colors which best represent all of the pixels in the textures (median cut). The textures must still be 32-bit
+	void build(const std::vector<const Texture*>& textures);
+
+	// Index of the palette color closest to color
+	uint8_t nearest(uint32_t color) const;
+
+	int size() const { return static_cast<int>(m_colors.size()); }
+
+	uint32_t operator[](int i) const { return m_colors[i]; }
+};
+
+// For each light level, every palette color already shaded to that level. Shading an indexed texel is then a single lookup
+// instead of a multiply per channel
+class Colormap
+{
+private:
+	std::vector<uint32_t> m_table{};	// LEVELS rows of Palette::MAX_COLORS colors
+
+public:
+	static const int LEVELS{ 64 };		// Number of light levels. Lighting goes from 0 to 255, so each level covers 4 of those
+
+	Colormap() = default;
+
+	void build(const Palette& palette);
+
+	// False until build() has filled in the table. Looking a color up before then reads past the end of it
+	bool isBuilt() const { return !m_table.empty(); }
+
+	// The shaded color of palette entry index at a light level
+	uint32_t lookup(int level, uint32_t index) const { return m_table[(level << 8) | index]; }
+
+	// The light level for a brightness from 0 to 255, like the ones the player's light produces
+	static int levelFromLighting(float lighting) { return static_cast<int>(lighting) >> 2; }
+
+	// The light level for a packed lightmap value. Indexed textures can't be tinted, so the brightest channel is used
+	static int levelFromLight(uint32_t light)
+	{
+		uint32_t red{ light >> 24 };
+		uint32_t green{ (light >> 16) & 0xFF };
+		uint32_t blue{ (light >> 8) & 0xFF };
+
+		return static_cast<int>(std::max(red, std::max(green, blue))) >> 2;
+	}
+};
+
+#endif
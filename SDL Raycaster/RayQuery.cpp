@@ -0,0 +1,250 @@
+#include "RayQuery.h"
+#include "Map.h"
+#include "Lightmap.h"
+#include "SDL.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	// Below this many rays per thread, waking the threads up costs more than it saves
+	const int minRaysPerThread{ 256 };
+}
+
+RayHit castRay(const Map& gridMap, const Ray& ray)
+{
+	const std::string& cells{ gridMap.cells() };
+	const int gridSize{ gridMap.gridSize() };
+	const int gridWidth{ gridMap.width() };
+	const int gridHeight{ gridMap.height() };
+
+	RayHit result{};
+	result.distance = ray.maxDistance;
+
+	int gridX{ static_cast<int>(floorf(ray.originX / gridSize)) };
+	int gridY{ static_cast<int>(floorf(ray.originY / gridSize)) };
+
+	// Everything outside of the map counts as solid (see Map::isSolid), so a ray which starts out there is already inside of
+	// something. It hits straight away, whichever way it points, so nothing can see out of the map or into it from outside
+	if (gridX < 0 || gridX >= gridWidth || gridY < 0 || gridY >= gridHeight)
+	{
+		result.hit = true;
+		result.gridX = gridX;
+		result.gridY = gridY;
+		result.distance = 0.0f;
+		return result;
+	}
+
+	float length{ sqrtf(ray.directionX * ray.directionX + ray.directionY * ray.directionY) };
+	if (length == 0.0f)
+		return result;
+
+	float directionX{ ray.directionX / length };
+	float directionY{ ray.directionY / length };
+
+	// A ray which starts inside of a door's cell only hits the door if it points at the closed part of it. The door is halfway
+	// through the cell, so the ray is followed to the middle of the cell and tested there the same way as any other door
+	if (cells[gridY * gridWidth + gridX] == Map::DOOR)
+	{
+		bool alongX{ gridMap.door(gridX, gridY)->alongX };
+		float middle{ ((alongX ? gridY : gridX) + 0.5f) * gridSize };
+		float origin{ alongX ? ray.originY : ray.originX };
+		float direction{ alongX ? directionY : directionX };
+		float distance{ direction != 0.0f ? (middle - origin) / direction : -1.0f };
+
+		// The point is already on the door, so there is no step to take towards it
+		float x{ ray.originX + directionX * distance };
+		float y{ ray.originY + directionY * distance };
+		int slide{};
+
+		if (distance >= 0.0f && distance <= ray.maxDistance)
+		{
+			if (gridMap.hitsDoor(gridX, gridY, alongX, x, y, 0.0f, 0.0f, slide))
+			{
+				result.hit = true;
+				result.gridX = gridX;
+				result.gridY = gridY;
+				result.distance = distance;
+				result.face = alongX ? (directionY > 0.0f ? Lightmap::NORTH : Lightmap::SOUTH) : (directionX > 0.0f ? Lightmap::WEST : Lightmap::EAST);
+				return result;
+			}
+		}
+	}
+	// A ray which starts inside of anything else solid hits it straight away
+	else if (gridMap.isSolid(gridX, gridY))
+	{
+		result.hit = true;
+		result.gridX = gridX;
+		result.gridY = gridY;
+		result.distance = 0.0f;
+		return result;
+	}
+
+	// Which way the ray steps through the grid, how far along the ray it is between two grid lines, and how far along the ray the
+	// next grid line is
+	int stepX{ directionX > 0.0f ? 1 : -1 };
+	int stepY{ directionY > 0.0f ? 1 : -1 };
+
+	float deltaX{ directionX != 0.0f ? fabsf(gridSize / directionX) : FLT_MAX };
+	float deltaY{ directionY != 0.0f ? fabsf(gridSize / directionY) : FLT_MAX };
+
+	float nextX{ FLT_MAX };
+	if (directionX > 0.0f)
+		nextX = ((gridX + 1) * gridSize - ray.originX) / directionX;
+	else if (directionX < 0.0f)
+		nextX = (ray.originX - gridX * gridSize) / -directionX;
+
+	float nextY{ FLT_MAX };
+	if (directionY > 0.0f)
+		nextY = ((gridY + 1) * gridSize - ray.originY) / directionY;
+	else if (directionY < 0.0f)
+		nextY = (ray.originY - gridY * gridSize) / -directionY;
+
+	while (true)
+	{
+		float distance{};
+		int face{};
+		bool crossingHorizontalLine{};
+		float stepDistance{};	// How far along the ray it is to the next grid line of the same kind
+
+		// Cross whichever grid line comes first
+		if (nextX < nextY)
+		{
+			gridX += stepX;
+			distance = nextX;
+			nextX += deltaX;
+			crossingHorizontalLine = false;
+			stepDistance = deltaX;
+
+			// Moving right means going through the left (west) face of the next block
+			face = stepX > 0 ? Lightmap::WEST : Lightmap::EAST;
+		}
+		else
+		{
+			gridY += stepY;
+			distance = nextY;
+			nextY += deltaY;
+			crossingHorizontalLine = true;
+			stepDistance = deltaY;
+
+			// Moving down means going through the top (north) face of the next block
+			face = stepY > 0 ? Lightmap::NORTH : Lightmap::SOUTH;
+		}
+
+		if (distance > ray.maxDistance || gridX < 0 || gridX >= gridWidth || gridY < 0 || gridY >= gridHeight)
+			return result;
+
+		// Most blocks are empty, so that is checked before the doors and walls
+		char cell{ cells[gridY * gridWidth + gridX] };
+		if (cell == Map::EMPTY)
+			continue;
+
+		// Doors are tested the same way the renderer tests them, so a query hits a door exactly where it is drawn
+		if (cell == Map::DOOR)
+		{
+			float x{ ray.originX + directionX * distance };
+			float y{ ray.originY + directionY * distance };
+			int slide{};
+
+			if (!gridMap.hitsDoor(gridX, gridY, crossingHorizontalLine, x, y, directionX * stepDistance, directionY * stepDistance, slide))
+				continue;
+
+			// The door is halfway through the cell
+			distance += stepDistance * 0.5f;
+			if (distance > ray.maxDistance)
+				return result;
+		}
+
+		if (gridMap.isSolid(gridX, gridY) || cell == Map::DOOR)
+		{
+			result.hit = true;
+			result.gridX = gridX;
+			result.gridY = gridY;
+			result.distance = distance;
+			result.face = face;
+			return result;
+		}
+	}
+}
+
+int castRays(const Map& gridMap, const Ray* rays, RayHit* hits, int count, WorkerPool* pool)
+{
+	int threads{ pool ? std::max(std::min(pool->threadCount(), count / minRaysPerThread), 1) : 1 };
+
+	if (threads == 1)
+	{
+		for (int i{ 0 }; i < count; i++)
+			hits[i] = castRay(gridMap, rays[i]);
+		return 1;
+	}
+
+	// Every thread gets its own range of the arrays, so they never write to the same place
+	int chunkSize{ (count + threads - 1) / threads };
+
+	pool->run(threads, [&gridMap, rays, hits, count, chunkSize](int chunk)
+	{
+		int last{ std::min((chunk + 1) * chunkSize, count) };
+
+		for (int i{ chunk * chunkSize }; i < last; i++)
+			hits[i] = castRay(gridMap, rays[i]);
+	});
+
+	return threads;
+}
+
+bool hasLineOfSight(const Map& gridMap, float fromX, float fromY, float toX, float toY)
+{
+	float dx{ toX - fromX };
+	float dy{ toY - fromY };
+
+	return !castRay(gridMap, Ray{ fromX, fromY, dx, dy, sqrtf(dx * dx + dy * dy) }).hit;
+}
+
+void benchmarkRayQueries(const Map& gridMap, int rayCount, int threads)
+{
+	const int gridSize{ gridMap.gridSize() };
+
+	// Random rays starting in open blocks, pointing in random directions
+	std::vector<Ray> rays(rayCount);
+	std::vector<RayHit> hits(rayCount);
+
+	srand(1);
+	for (Ray& ray : rays)
+	{
+		do
+		{
+			ray.originX = static_cast<float>(rand() % (gridMap.width() * gridSize));
+			ray.originY = static_cast<float>(rand() % (gridMap.height() * gridSize));
+		} while (gridMap.isSolid(static_cast<int>(ray.originX) / gridSize, static_cast<int>(ray.originY) / gridSize));
+
+		float angle{ static_cast<float>(rand()) / RAND_MAX * 2.0f * static_cast<float>(M_PI) };
+		ray.directionX = cosf(angle);
+		ray.directionY = sinf(angle);
+		ray.maxDistance = static_cast<float>(gridSize * std::max(gridMap.width(), gridMap.height()));
+	}
+
+	// Run the batch a few times so the timing isn't dominated by the first, cold run
+	const int repeats{ 10 };
+
+	// The threads are started before the timing starts, and reused for every batch
+	WorkerPool pool{ threads };
+	int threadsUsed{ 1 };
+
+	Uint64 start{ SDL_GetPerformanceCounter() };
+	for (int i{ 0 }; i < repeats; i++)
+		threadsUsed = castRays(gridMap, rays.data(), hits.data(), rayCount, &pool);
+	double seconds{ static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency() };
+
+	int hitCount{ 0 };
+	for (const RayHit& hit : hits)
+		hitCount += hit.hit ? 1 : 0;
+
+	double queriesPerSecond{ seconds > 0.0 ? static_cast<double>(rayCount) * repeats / seconds : 0.0 };
+
+	std::cout << "Cast " << rayCount << " rays " << repeats << " times on " << threadsUsed << " threads in " << seconds << " seconds (" << hitCount << " hit a wall)\n";
+	std::cout << "Throughput: " << queriesPerSecond << " queries per second\n";
+}
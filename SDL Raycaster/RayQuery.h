@@ -0,0 +1,44 @@
+#ifndef RAYQUERY_H
+#define RAYQUERY_H
+
+#include "Map.h"
+#include "WorkerPool.h"
+
+// A ray for game logic (line of sight, hitscan, sound occlusion...) rather than rendering. Coordinates are in pixels, like playerX
+// and playerY. The direction doesn't have to be normalized
+struct Ray
+{
+	float originX{};
+	float originY{};
+	float directionX{};
+	float directionY{};
+	float maxDistance{};
+};
+
+struct RayHit
+{
+	bool hit{};			// False if the ray reached maxDistance or left the map without hitting anything
+	int gridX{ -1 };	// The block that was hit. Can be outside of the map if the ray started there
+	int gridY{ -1 };
+	float distance{};	// Distance to the hit, or maxDistance if nothing was hit
+	int face{ -1 };		// The face of the block that was hit, as a Lightmap::Face. -1 if the ray started inside of the block
+};
+
+// Cast one ray through the grid, stopping at the first solid block (see Map::isSolid). Steps from one grid line to the next, so the
+// cost depends on how many blocks the ray crosses, not how far it goes in pixels. A ray which starts outside of the map hits the
+// block it starts in at distance 0 with face -1, the same as a ray starting inside of a wall, since everything out there is solid
+RayHit castRay(const Map& gridMap, const Ray& ray);
+
+// Cast count rays, writing the results to hits. With a pool the rays are split into even chunks, one per thread, as long as each
+// thread gets enough rays to be worth waking it up for. Returns the number of threads that cast rays. The map must not be changed
+// until this returns
+int castRays(const Map& gridMap, const Ray* rays, RayHit* hits, int count, WorkerPool* pool = nullptr);
+
+// True if nothing solid is between the two points. Always false if fromX, fromY is outside of the map
+bool hasLineOfSight(const Map& gridMap, float fromX, float fromY, float toX, float toY);
+
+// Cast rayCount random rays from open blocks of the map as a batch on a pool of the given number of threads, and print how many
+// queries per second were done
+void benchmarkRayQueries(const Map& gridMap, int rayCount, int threads);
+
+#endif
@@ -0,0 +1,736 @@
+#include "Renderer.h"
+#include "Angles.h"
+#include "Texture.h"
+#include "SDL.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+// Every setting the kernel is templated on is a compile time constant inside of it, so the compiler can remove the branches on
+// DEBUG and the lighting mode, and turn the divisions by gridSize and the texture dimensions into shifts and masks. The
+// dispatcher at the bottom of the file picks the right version once at startup
+
+namespace
+{
+	// Restrict angles to 0 - 360 degrees
+	inline float getCoterminalAngle(float angle)
+	{
+		if (angle < 0.0f)
+		{
+			while (angle < 0)
+			{
+				angle += 360.0f;
+			}
+			return angle;
+		}
+		else if (angle >= 360.0f)
+			return angle - (static_cast<int>(angle / 360) * 360);
+		else return angle;
+	}
+
+	inline uint32_t calculateLighting(const uint32_t& color, const float& lighting)
+	{
+		uint32_t red{ color >> 24 };
+		uint32_t green{ (color >> 16) - (red << 8) };
+		uint32_t blue{ (color >> 8) - (red << 16) - (green << 8) };
+
+		// Calculate the brightness of each color according to the lighting
+		red = static_cast<uint32_t>(red * 0.0039215686f * lighting);
+		green = static_cast<uint32_t>(green * 0.0039215686f * lighting);
+		blue = static_cast<uint32_t>(blue * 0.0039215686f * lighting);
+
+		// Move the compontents to their original hex positions
+		red <<= 24;
+		green <<= 16;
+		blue <<= 8;
+
+		// Create a new color from the components and output it to the screen
+		return uint32_t{ red + green + blue + 0x000000FF };
+	}
+
+	// Calculate the lighting a texel experiences, if the player were a light
+	inline float playerLight(float distance)
+	{
+		float lighting{ -0.4f * distance + 255.0f };
+
+		// If the light level is less than 0, clamp to zero
+		if (lighting < 0.0f)
+			lighting = 0.0f;
+
+		return lighting;
+	}
+
+	// Shade a texel that is distance units away from the player. bakedLight is the lightmap value of the surface the texel is on,
+	// and is only used by LightingMode::BAKED. For indexed textures the texel is a palette index, and the colormap does the shading
+	template <LightingMode Lighting, bool IndexedTextures>
+	inline uint32_t shade(uint32_t texel, float distance, uint32_t bakedLight, const RenderContext& context)
+	{
+		if (IndexedTextures)
+		{
+			int level{ Colormap::LEVELS - 1 };
+
+			if (Lighting == LightingMode::BAKED)
+				level = Colormap::levelFromLight(bakedLight);
+			else if (Lighting == LightingMode::PLAYER_LIGHT)
+				level = Colormap::levelFromLighting(playerLight(distance));
+
+			return context.colormap->lookup(level, texel);
+		}
+
+		if (Lighting == LightingMode::FLAT)
+			return texel;
+
+		if (Lighting == LightingMode::BAKED)
+			return Lightmap::apply(texel, bakedLight);
+
+		return calculateLighting(texel, playerLight(distance));
+	}
+
+	// How much of the fog covers something distance units away, from 0 (none) to 256 (nothing but fog)
+	inline uint32_t fogAmount(float distance, const RenderContext& context)
+	{
+		if (distance <= context.fogStart)
+			return 0;
+
+		if (distance >= context.viewDistance)
+			return 256;
+
+		return static_cast<uint32_t>((distance - context.fogStart) / (context.viewDistance - context.fogStart) * 256.0f);
+	}
+
+	// Blend a shaded color towards the fog color
+	inline uint32_t applyFog(uint32_t color, uint32_t fogColor, uint32_t amount)
+	{
+		uint32_t keep{ 256 - amount };
+
+		uint32_t red{ ((color >> 24) * keep + (fogColor >> 24) * amount) >> 8 };
+		uint32_t green{ (((color >> 16) & 0xFF) * keep + ((fogColor >> 16) & 0xFF) * amount) >> 8 };
+		uint32_t blue{ (((color >> 8) & 0xFF) * keep + ((fogColor >> 8) & 0xFF) * amount) >> 8 };
+
+		return (red << 24) | (green << 16) | (blue << 8) | 0x000000FF;
+	}
+
+	// Convert a coordinate in pixels to a coordinate in grid blocks
+	template <bool PowerOfTwoGrid>
+	inline int toGrid(float coordinate, const RenderContext& context)
+	{
+		if (PowerOfTwoGrid)
+			return static_cast<int>(coordinate) >> context.gridShift;
+		else
+			return static_cast<int>(coordinate / context.gridSize);
+	}
+
+	// The offset of a (non-negative) pixel coordinate from the edge of the grid block it is in
+	template <bool PowerOfTwoGrid>
+	inline int offsetInGrid(int coordinate, const RenderContext& context)
+	{
+		if (PowerOfTwoGrid)
+			return coordinate & (context.gridSize - 1);
+		else
+			return coordinate - (coordinate / context.gridSize) * context.gridSize;
+	}
+
+	// Scale an offset within a grid block (0 <= offset < gridSize) to an offset within a texture dimension
+	template <bool PowerOfTwoGrid>
+	inline int gridToTexture(int offset, int textureSize, const RenderContext& context)
+	{
+		if (PowerOfTwoGrid)
+			return (offset * textureSize) >> context.gridShift;
+		else
+			return offset * textureSize / context.gridSize;
+	}
+
+	// Fetch a texel, which is a color, or a palette index for indexed textures. Power of two textures wrap the coordinates with a
+	// mask so the bounds check isn't needed
+	template <bool PowerOfTwoTextures, bool IndexedTextures>
+	inline uint32_t fetch(const Texture& texture, int column, int row)
+	{
+		if (PowerOfTwoTextures)
+		{
+			int i{ ((row & (texture.m_height - 1)) << texture.m_widthShift) + (column & (texture.m_width - 1)) };
+			return IndexedTextures ? texture.indices()[i] : texture.pixels()[i];
+		}
+		else
+			return IndexedTextures ? texture.index(row * texture.m_width + column) : texture[row * texture.m_width + column];
+	}
+
+	// The ray pass. Finds the wall the ray for column x hits and saves everything the shading pass needs to know about it to the
+	// column buffer. Doesn't touch the screen
+	template <bool Debug, bool PowerOfTwoGrid, bool PowerOfTwoTextures, bool IndexedTextures, bool Fog, LightingMode Lighting>
+	void traceColumn(const RenderContext& context, int x)
+	{
+		const std::string& gridMap{ context.gridMap->cells() };
+		const int gridSize{ context.gridSize };
+		const int gridWidth{ context.gridWidth };
+		const int gridHeight{ context.gridHeight };
+		const float playerX{ context.camera.x };
+		const float playerY{ context.camera.y };
+		const float theta{ context.camera.theta };
+		const int width{ context.width };
+
+		// Rays which get this far (squared, so the check doesn't need a square root) only see fog
+		const float viewDistanceSquared{ context.viewDistance * context.viewDistance };
+
+		// Calculate the angle between two rays
+		float angleBetween{ degrees(atanf(static_cast<float>(x - (width / 2)) / context.adjustedDistanceToProjectionPlane)) };
+
+		// Find the angle of the ray
+		float rayAngle{ theta - angleBetween };
+
+		// Precalculate the value of tan of rayAngle because that value is used eight times
+		float tanOfRayAngle{ tanf(radians(rayAngle)) };
+
+		// Find the angle of the ray on the interval 0 <= rayAngle < 360
+		rayAngle = getCoterminalAngle(rayAngle);
+
+		if (rayAngle == 360.0f)
+			rayAngle = 0.0f;
+
+		// These two boolean values are used to determine how to texture the wall by determining which side of the wall the ray hit
+		bool topOrBottom{};	// True means the ray hit the top of the wall, false means it hit the bottom
+		bool leftOrRight{};	// True means the ray hit the left of the wall, false means it hit the right
+
+		// CALCULATE HORIZONTAL INTERSECTIONS
+		float horizontalIntersectionsDistance{ -1.0f };
+
+		// Point A is the point of the first intersection between the ray and the horizontal grid lines
+		float aX{};
+		float aY{};
+
+		// The change between point A and the next intersection with the horizontal grid lines
+		float dx{};
+		float dy{};
+
+		// If the ray is facing up... (or downwards on the coordinate grid)
+		if (rayAngle < 180)
+		{
+			// Because the ray is pointing up, that means it will hit the bottoms of the wall
+			topOrBottom = false;
+
+			// The first intersection will be part of the grid below (calculates y-coordinate of grid line below)
+			aY = static_cast<float>(toGrid<PowerOfTwoGrid>(playerY, context) * gridSize);
+
+			// The next intersection with a horizontal grid line will be gridSize units below
+			dy = -static_cast<float>(gridSize);
+
+			// When rayAngle < 90, dx should be >0, and when rayAngle > 90, dx should be <0
+			// It just so happens that tan is >0 when rayAngle < 90 degrees, and tan is <0 when rayAngle > 90
+			// so I don't have to change the signs at all
+			dx = gridSize / tanOfRayAngle;
+
+			// Calculate the x-coordinate of the first intersection with a horizontal gridline
+			aX = playerX - (aY - playerY) / tanOfRayAngle;
+
+			// Make part of the grid below for ease of checking for a wall
+			aY--;
+		}
+		// If ray is facing down... (or upwards on the coordinate grid)
+		else
+		{
+			// The ray is facing down, so the ray hits the top of the wall
+			topOrBottom = true;
+
+			// The first horizontal grid intersection is with the grid line above the player
+			aY = static_cast<float>(toGrid<PowerOfTwoGrid>(playerY, context) * gridSize + gridSize);
+
+			// The next gridline with be gridSize units above the player
+			dy = static_cast<float>(gridSize);
+
+			// When rayAngle < 270, dx should be <0, and when rayAngle > 270, dx should be >0
+			// It just so happens that tan is >0 when rayAngle < 270 degrees, and tan is <0 when rayAngle > 270
+			// so I have to flip the signs with the negative
+			dx = -gridSize / tanOfRayAngle;
+
+			// Calculate the x-coordinate of the first intersection with a horizontal gridline
+			aX = playerX - (aY - playerY) / tanOfRayAngle;
+		}
+
+		// Grid coordinates of point A
+		int aXgrid{};
+		int aYgrid{};
+
+		// How far the door point A hit has slid open, if it hit one
+		int aDoorSlide{ 0 };
+
+		// Until a wall has been found and a distance can be calculated...
+		while (horizontalIntersectionsDistance < 0.0f)
+		{
+			aXgrid = toGrid<PowerOfTwoGrid>(aX, context);
+			aYgrid = toGrid<PowerOfTwoGrid>(aY, context);
+
+			// If point A has left the map, ignore it
+			if (aXgrid < 0 || aXgrid >= gridWidth || aYgrid < 0 || aYgrid >= gridHeight)
+			{
+				horizontalIntersectionsDistance = FLT_MAX;
+				continue;
+			}
+
+			// Past the view distance there is nothing but fog, so there is no point looking any further. The ray counts as having
+			// left the map
+			if (Fog && (playerX - aX) * (playerX - aX) + (playerY - aY) * (playerY - aY) > viewDistanceSquared)
+			{
+				aXgrid = -1;
+				horizontalIntersectionsDistance = FLT_MAX;
+				continue;
+			}
+
+			char cell{ gridMap[aYgrid * gridWidth + aXgrid] };
+
+			// If there is a wall (or the closed part of a door) in that grid, calculate the distance
+			if (cell != Map::EMPTY && (cell != Map::DOOR || context.gridMap->hitsDoor(aXgrid, aYgrid, true, aX, aY, dx, dy, aDoorSlide)))
+			{
+				horizontalIntersectionsDistance = sqrtf((playerX - aX) * (playerX - aX) + (playerY - aY) * (playerY - aY));
+			}
+			// Otherwise find the next intersection with a horizontal grid line
+			else
+			{
+				aX += dx;
+				aY += dy;
+			}
+		}
+
+		// Once the intersection point has been found, save it for debugging purposes
+		if (Debug)
+			context.debug->aPoints[x] = point{ aX, aY };
+
+		// CALCULATE VERTICAL INTERSECTIONS (very similar to calculating horizontal intersections)
+		float verticalIntersectionsDistance{ -1.0f };
+
+		// Point B is the point of the first intersection between the ray and the vertical grid lines
+		float bX{};
+		float bY{};
+
+		// If the ray is facing to the right...
+		if (rayAngle < 90.0f || rayAngle > 270.0f)
+		{
+			// The ray is facing to the right, so it will hit the left wall
+			leftOrRight = true;
+
+			// The first intersection will be in a grid to the right of the current grid
+			bX = static_cast<float>(toGrid<PowerOfTwoGrid>(playerX, context) * gridSize + gridSize);
+
+			// The ray is moving in a positive x-direction
+			dx = static_cast<float>(gridSize);
+
+			// When rayAngle < 180, dy should be <0, and when rayAngle > 180, dy should be >0
+			// It just so happens that tan is >0 when rayAngle < 180 degrees, and tan is <0 when rayAngle > 180
+			// so I have to flip the signs with the negative
+			dy = -tanOfRayAngle * gridSize;
+
+			// Calculate the y-coordinate of the first intersection with a vertical gridline
+			bY = playerY + (playerX - bX) * tanOfRayAngle;
+		}
+		// If the ray is facing to the left...
+		else
+		{
+			// The ray is facing left so it will hit the wall to the right
+			leftOrRight = false;
+
+			// The first intersection will be in a grid to the left
+			bX = static_cast<float>(toGrid<PowerOfTwoGrid>(playerX, context) * gridSize);
+
+			// The ray is moving in a negative x-direction
+			dx = -static_cast<float>(gridSize);
+
+			// When rayAngle < 180, dy should be <0, and when rayAngle > 180, dy should be >0
+			// It just so happens that tan is <0 when rayAngle < 180 degrees, and tan is >0 when rayAngle > 180
+			// so I don't have to change the signs at all
+			dy = tanOfRayAngle * gridSize;
+
+			// Calculate the y-coordinate of the first intersection with a vertical gridline
+			bY = playerY + (playerX - bX) * tanOfRayAngle;
+
+			bX--;
+		}
+
+		// Same process as with the horizontal intersection code
+		int bXgrid{};
+		int bYgrid{};
+		int bDoorSlide{ 0 };
+
+		while (verticalIntersectionsDistance < 0.0f)
+		{
+			bXgrid = toGrid<PowerOfTwoGrid>(bX, context);
+			bYgrid = toGrid<PowerOfTwoGrid>(bY, context);
+
+			if (bXgrid < 0 || bXgrid >= gridWidth || bYgrid < 0 || bYgrid >= gridHeight)
+			{
+				verticalIntersectionsDistance = FLT_MAX;
+				continue;
+			}
+
+			if (Fog && (playerX - bX) * (playerX - bX) + (playerY - bY) * (playerY - bY) > viewDistanceSquared)
+			{
+				bXgrid = -1;
+				verticalIntersectionsDistance = FLT_MAX;
+				continue;
+			}
+
+			char cell{ gridMap[bYgrid * gridWidth + bXgrid] };
+
+			if (cell != Map::EMPTY && (cell != Map::DOOR || context.gridMap->hitsDoor(bXgrid, bYgrid, false, bX, bY, dx, dy, bDoorSlide)))
+			{
+				verticalIntersectionsDistance = sqrtf((playerX - bX) * (playerX - bX) + (playerY - bY) * (playerY - bY));
+			}
+			else
+			{
+				bX += dx;
+				bY += dy;
+			}
+		}
+
+		// Again, once the intersection point has been found, save it for debugging purposes
+		if (Debug)
+			context.debug->bPoints[x] = point{ bX, bY };
+
+		// The column the ray hits on a wall
+		int gridSpaceColumn{};
+
+		// The grid block that was hit, and the face of it
+		int hitXgrid{};
+		int hitYgrid{};
+		int side{};
+
+		// The light on the face of the wall that was hit. It is the same for the whole sliver
+		uint32_t wallLight{};
+
+		// The ray used for rendering is the shorter one, so save the one which is a smaller distance away to the actual intersection
+		// points vector
+		if (horizontalIntersectionsDistance < verticalIntersectionsDistance)
+		{
+			if (Debug)
+				context.debug->actualPoints[x] = context.debug->aPoints[x];
+
+			hitXgrid = aXgrid;
+			hitYgrid = aYgrid;
+
+			// x-coordinate of intersection with wall, relative to the left side of the grid block. A door's texture slides along
+			// with it
+			int intersectionX{ offsetInGrid<PowerOfTwoGrid>(static_cast<int>(aX), context) - aDoorSlide };
+
+			// If the ray hit the top of a wall, the first column is at the top left corner of the wall. If it hit the bottom, the
+			// first column is at the bottom right corner
+			gridSpaceColumn = topOrBottom ? (gridSize - 1) - intersectionX : intersectionX;
+			side = topOrBottom ? Lightmap::NORTH : Lightmap::SOUTH;
+
+			if (Lighting == LightingMode::BAKED && horizontalIntersectionsDistance != FLT_MAX)
+				wallLight = context.lightmap->wall(aXgrid, aYgrid, topOrBottom ? Lightmap::NORTH : Lightmap::SOUTH);
+		}
+		else
+		{
+			if (Debug)
+				context.debug->actualPoints[x] = context.debug->bPoints[x];
+
+			hitXgrid = bXgrid;
+			hitYgrid = bYgrid;
+
+			// y-coordinate of intersection with the wall, relative to the top of the grid block
+			int intersectionY{ offsetInGrid<PowerOfTwoGrid>(static_cast<int>(bY), context) - bDoorSlide };
+
+			// If the ray hit the left side of the wall, the first column is at the top left corner of the wall. If it hit the right
+			// side, the first column is at the bottom right corner
+			gridSpaceColumn = leftOrRight ? intersectionY : (gridSize - 1) - intersectionY;
+			side = leftOrRight ? Lightmap::WEST : Lightmap::EAST;
+
+			if (Lighting == LightingMode::BAKED && verticalIntersectionsDistance != FLT_MAX)
+				wallLight = context.lightmap->wall(bXgrid, bYgrid, leftOrRight ? Lightmap::WEST : Lightmap::EAST);
+		}
+
+		// Doors are in open cells as far as the lightmap is concerned, so they get the light of the floor around them
+		bool hitSomething{ hitXgrid >= 0 && hitXgrid < gridWidth && hitYgrid >= 0 && hitYgrid < gridHeight };
+		if (Lighting == LightingMode::BAKED && hitSomething && gridMap[hitYgrid * gridWidth + hitXgrid] == Map::DOOR)
+			wallLight = context.lightmap->floor(hitXgrid, hitYgrid);
+
+		if (!hitSomething)
+			side = -1;
+
+		// Determine the smaller distance
+		float distance{ std::min(horizontalIntersectionsDistance, verticalIntersectionsDistance) };
+
+		// The lighting of the wall uses the actual distance, not the one corrected for fish-eye
+		float lightingDistance{ distance };
+
+		// Correct fish-eye distortion for the actual rendering of the walls
+		distance *= cosf(radians(theta - rayAngle));
+
+		// Calculate the height of the wall
+		int wallHeight{ static_cast<int>((context.distanceToProjectionPlane * gridSize) / distance) };
+
+		// Y-coordinates of the bottom and top of the wall. Calculated in terms of player height and projection plane center (using similar
+		// triangles) so that when the player height changes, the location of the wall will as well
+		int bottomOfWall{ static_cast<int>(context.camera.projectionPlaneCenter + (context.distanceToProjectionPlane * context.camera.height) / distance) };
+		int topOfWall{ bottomOfWall - wallHeight };
+
+		// Each wall block picks its own texture
+		unsigned int textureId{ hitSomething ? context.gridMap->textureId(hitXgrid, hitYgrid) : 0u };
+		textureId = textureId < context.wallTextures.size() ? textureId : 0;
+
+		// The column on the texture which corresponds to the position of the ray intersection with the wall
+		int textureSpaceColumn{ gridToTexture<PowerOfTwoGrid>(gridSpaceColumn, context.wallTextures[textureId]->m_width, context) };
+
+		ColumnBuffer& columns{ *context.columns };
+		columns.rayAngle[x] = rayAngle;
+		columns.rayLength[x] = lightingDistance;
+		columns.distance[x] = distance;
+		columns.wallTop[x] = topOfWall;
+		columns.wallBottom[x] = bottomOfWall;
+		columns.textureId[x] = static_cast<int>(textureId);
+		columns.textureColumn[x] = textureSpaceColumn;
+		columns.side[x] = static_cast<int8_t>(side);
+		columns.light[x] = wallLight;
+	}
+
+	// The shading pass. Fills in column x of the screen from what the ray pass saved: the wall sliver, then the floor below it and
+	// the ceiling above it
+	template <bool Debug, bool PowerOfTwoGrid, bool PowerOfTwoTextures, bool IndexedTextures, bool Fog, LightingMode Lighting>
+	void shadeColumn(const RenderContext& context, int x)
+	{
+		const ColumnBuffer& columns{ *context.columns };
+		const int gridSize{ context.gridSize };
+		const int gridWidth{ context.gridWidth };
+		const int gridHeight{ context.gridHeight };
+		const float playerX{ context.camera.x };
+		const float playerY{ context.camera.y };
+		const float theta{ context.camera.theta };
+		const int pitch{ context.pitch > 0 ? context.pitch : context.width };
+		const int height{ context.height };
+		uint32_t* screen{ context.screen };
+
+		float rayAngle{ columns.rayAngle[x] };
+		float lightingDistance{ columns.rayLength[x] };
+		int topOfWall{ columns.wallTop[x] };
+		int bottomOfWall{ columns.wallBottom[x] };
+		int wallHeight{ bottomOfWall - topOfWall };
+		int textureSpaceColumn{ columns.textureColumn[x] };
+		uint32_t wallLight{ columns.light[x] };
+
+		const Texture& wallTexture{ *context.wallTextures[columns.textureId[x]] };
+
+		float cosOfThetaMinusRayAngle{ cosf(radians(theta - rayAngle)) };
+
+		// If I put std::min(bottomOfWall, height) into the for loop, it would evaluate every iteration, which is wasteful
+		// because the value doesn't change
+		int minBetweenHeightAndBottomOfWall{ std::min(bottomOfWall, height) };
+
+		// Texture rows per screen row. Calculated once here instead of dividing by wallHeight for every pixel
+		float textureRowsPerPixel{ static_cast<float>(wallTexture.m_height) / wallHeight };
+
+		// The whole sliver is the same distance away, so it is all under the same amount of fog
+		uint32_t wallFog{ Fog ? fogAmount(lightingDistance, context) : 0 };
+
+		// Draw the wall sliver
+		for (int y{ std::max(topOfWall, 0) }; y < minBetweenHeightAndBottomOfWall; y++)
+		{
+			// The row on the texture
+			int textureSpaceRow{ static_cast<int>((y - topOfWall) * textureRowsPerPixel) };
+
+			// Get the color of the texture at the point on the wall (x, y)
+			uint32_t color{ fetch<PowerOfTwoTextures, IndexedTextures>(wallTexture, textureSpaceColumn, textureSpaceRow) };
+
+			color = shade<Lighting, IndexedTextures>(color, lightingDistance, wallLight, context);
+
+			if (Fog)
+				color = applyFog(color, context.fogColor, wallFog);
+
+			screen[y * pitch + x] = color;
+		}
+
+		// Precalculate some values that will be used in the for loops below
+		float cosOfRayAngle{ cosf(radians(rayAngle)) };
+		float sinOfRayAngle{ sinf(radians(rayAngle)) };
+		float mapWidthInPixels{ static_cast<float>(gridWidth * gridSize) };
+		float mapHeightInPixels{ static_cast<float>(gridHeight * gridSize) };
+
+		const Texture& floorTexture{ *context.floorTexture };
+
+		int firstFloorRow{ std::max(bottomOfWall, 0) };
+
+		if (Fog)
+		{
+			// The floor is at the view distance on this row. The rows between it and the bottom of the wall are further away, so
+			// they are filled with the fog color without working out where on the floor they are
+			float fogRow{ context.camera.projectionPlaneCenter + static_cast<float>(context.camera.height * context.distanceToProjectionPlane) / (context.viewDistance * cosOfThetaMinusRayAngle) };
+			int firstClearRow{ std::min(static_cast<int>(floorf(fogRow)) + 1, height) };
+
+			for (; firstFloorRow < firstClearRow; firstFloorRow++)
+				screen[firstFloorRow * pitch + x] = context.fogColor;
+		}
+
+		// Floor cast
+		// y is a point on the projection plane from the bottom of the wall to the end of the screen
+		for (int y{ firstFloorRow }; y < height; y++)
+		{
+			// The straight, vertical line distance to the point on the floor
+			float straightDistance{ static_cast<float>(context.camera.height * context.distanceToProjectionPlane) / (y - context.camera.projectionPlaneCenter) };
+
+			// The corrected distance to the point on the floor (reverse fisheye)
+			float correctedDistance{ straightDistance / cosOfThetaMinusRayAngle };
+
+			// Calculate the location on the floor of the map of the current point
+			float pX{ playerX + correctedDistance * cosOfRayAngle };
+			float pY{ playerY + correctedDistance * -sinOfRayAngle };
+
+			// Check if the point is outside the map. Happens when the player's height is very small
+			if (pX < 0.0f || pX >= mapWidthInPixels || pY < 0.0f || pY >= mapHeightInPixels)
+				continue;
+
+			if (Debug)
+				context.debug->floorPoints.push_back(point{ pX, pY });
+
+			// Calculate the coordinates of point P in texture space
+			int textureX{ gridToTexture<PowerOfTwoGrid>(offsetInGrid<PowerOfTwoGrid>(static_cast<int>(pX), context), floorTexture.m_width, context) };
+			int textureY{ gridToTexture<PowerOfTwoGrid>(offsetInGrid<PowerOfTwoGrid>(static_cast<int>(pY), context), floorTexture.m_height, context) };
+
+			// Look up the light of the floor cell P is in
+			uint32_t floorLight{ Lighting == LightingMode::BAKED ? context.lightmap->floor(toGrid<PowerOfTwoGrid>(pX, context), toGrid<PowerOfTwoGrid>(pY, context)) : 0 };
+
+			uint32_t color{ shade<Lighting, IndexedTextures>(fetch<PowerOfTwoTextures, IndexedTextures>(floorTexture, textureX, textureY), correctedDistance, floorLight, context) };
+
+			if (Fog)
+				color = applyFog(color, context.fogColor, fogAmount(correctedDistance, context));
+
+			screen[y * pitch + x] = color;
+		}
+
+		const Texture& ceilingTexture{ *context.ceilingTexture };
+
+		int firstCeilingRow{ std::min(topOfWall, height - 1) };
+
+		if (Fog)
+		{
+			// Same as the floor, the rows between the top of the wall and this one are past the view distance
+			float fogRow{ context.camera.projectionPlaneCenter - static_cast<float>((gridSize - context.camera.height) * context.distanceToProjectionPlane) / (context.viewDistance * cosOfThetaMinusRayAngle) };
+			int lastFoggedRow{ std::max(static_cast<int>(ceilf(fogRow)), 1) };
+
+			for (; firstCeilingRow >= lastFoggedRow; firstCeilingRow--)
+				screen[firstCeilingRow * pitch + x] = context.fogColor;
+		}
+
+		// Ceiling casting. Basically the same process as floorcasting, except from the top of the wall up
+		for (int y{ firstCeilingRow }; y > 0; y--)
+		{
+			// The straight, vertical line distance to the point on the ceiling
+			float straightDistance{ static_cast<float>((gridSize - context.camera.height) * context.distanceToProjectionPlane) / (context.camera.projectionPlaneCenter - y) };
+
+			// The corrected distance to the point on the ceiling (Reverse fish eye)
+			float correctedDistance{ straightDistance / cosOfThetaMinusRayAngle };
+
+			// Calculate the location on the ceiling of the map of the current point
+			float pX{ playerX + correctedDistance * cosOfRayAngle };
+			float pY{ playerY + correctedDistance * -sinOfRayAngle };
+
+			// Check if the point is outside of the map. Happens when the player's height is large
+			if (pX < 0.0f || pX >= mapWidthInPixels || pY < 0.0f || pY >= mapHeightInPixels)
+				continue;
+
+			// Calculate the coordinates of point P in texture space
+			int textureX{ gridToTexture<PowerOfTwoGrid>(offsetInGrid<PowerOfTwoGrid>(static_cast<int>(pX), context), ceilingTexture.m_width, context) };
+			int textureY{ gridToTexture<PowerOfTwoGrid>(offsetInGrid<PowerOfTwoGrid>(static_cast<int>(pY), context), ceilingTexture.m_height, context) };
+
+			uint32_t ceilingLight{ Lighting == LightingMode::BAKED ? context.lightmap->ceiling(toGrid<PowerOfTwoGrid>(pX, context), toGrid<PowerOfTwoGrid>(pY, context)) : 0 };
+
+			uint32_t color{ shade<Lighting, IndexedTextures>(fetch<PowerOfTwoTextures, IndexedTextures>(ceilingTexture, textureX, textureY), correctedDistance, ceilingLight, context) };
+
+			if (Fog)
+				color = applyFog(color, context.fogColor, fogAmount(correctedDistance, context));
+
+			screen[y * pitch + x] = color;
+		}
+	}
+
+	template <bool Debug, bool PowerOfTwoGrid, bool PowerOfTwoTextures, bool IndexedTextures, bool Fog, LightingMode Lighting>
+	void castColumns(const RenderContext& context, int firstColumn, int lastColumn)
+	{
+		// Send a ray out into the scene for each vertical row of pixels in the screen array, then shade them all from the column
+		// buffer
+		for (int x{ firstColumn }; x < lastColumn; x++)
+			traceColumn<Debug, PowerOfTwoGrid, PowerOfTwoTextures, IndexedTextures, Fog, Lighting>(context, x);
+
+		for (int x{ firstColumn }; x < lastColumn; x++)
+			shadeColumn<Debug, PowerOfTwoGrid, PowerOfTwoTextures, IndexedTextures, Fog, Lighting>(context, x);
+	}
+
+	// Each of these turns one runtime setting into a template argument, then hands off to the next
+	template <bool Debug, bool PowerOfTwoGrid, bool PowerOfTwoTextures, bool IndexedTextures, bool Fog>
+	ColumnRenderer selectLighting(LightingMode lighting)
+	{
+		switch (lighting)
+		{
+		case LightingMode::FLAT:
+			return &castColumns<Debug, PowerOfTwoGrid, PowerOfTwoTextures, IndexedTextures, Fog, LightingMode::FLAT>;
+		case LightingMode::BAKED:
+			return &castColumns<Debug, PowerOfTwoGrid, PowerOfTwoTextures, IndexedTextures, Fog, LightingMode::BAKED>;
+		case LightingMode::PLAYER_LIGHT:
+		default:
+			return &castColumns<Debug, PowerOfTwoGrid, PowerOfTwoTextures, IndexedTextures, Fog, LightingMode::PLAYER_LIGHT>;
+		}
+	}
+
+	template <bool Debug, bool PowerOfTwoGrid, bool PowerOfTwoTextures, bool IndexedTextures>
+	ColumnRenderer selectFog(bool fog, LightingMode lighting)
+	{
+		return fog ? selectLighting<Debug, PowerOfTwoGrid, PowerOfTwoTextures, IndexedTextures, true>(lighting) : selectLighting<Debug, PowerOfTwoGrid, PowerOfTwoTextures, IndexedTextures, false>(lighting);
+	}
+
+	template <bool Debug, bool PowerOfTwoGrid, bool PowerOfTwoTextures>
+	ColumnRenderer selectIndexed(bool indexedTextures, bool fog, LightingMode lighting)
+	{
+		return indexedTextures ? selectFog<Debug, PowerOfTwoGrid, PowerOfTwoTextures, true>(fog, lighting) : selectFog<Debug, PowerOfTwoGrid, PowerOfTwoTextures, false>(fog, lighting);
+	}
+
+	template <bool Debug, bool PowerOfTwoGrid>
+	ColumnRenderer selectTextures(bool powerOfTwoTextures, bool indexedTextures, bool fog, LightingMode lighting)
+	{
+		return powerOfTwoTextures ? selectIndexed<Debug, PowerOfTwoGrid, true>(indexedTextures, fog, lighting) : selectIndexed<Debug, PowerOfTwoGrid, false>(indexedTextures, fog, lighting);
+	}
+
+	template <bool Debug>
+	ColumnRenderer selectGrid(bool powerOfTwoGrid, bool powerOfTwoTextures, bool indexedTextures, bool fog, LightingMode lighting)
+	{
+		return powerOfTwoGrid ? selectTextures<Debug, true>(powerOfTwoTextures, indexedTextures, fog, lighting) : selectTextures<Debug, false>(powerOfTwoTextures, indexedTextures, fog, lighting);
+	}
+}
+
+ColumnRenderer selectColumnRenderer(const RenderContext& context, bool debug, LightingMode lighting)
+{
+	bool powerOfTwoGrid{ context.gridShift >= 0 && (1 << context.gridShift) == context.gridSize };
+	bool powerOfTwoTextures{ context.floorTexture->isPowerOfTwo() && context.ceilingTexture->isPowerOfTwo() };
+
+	// The indexed kernel is only used if every texture is indexed. Mixing the two would need a branch per texel
+	bool indexedTextures{ context.floorTexture->isIndexed() && context.ceilingTexture->isIndexed() };
+	bool anyIndexed{ context.floorTexture->isIndexed() || context.ceilingTexture->isIndexed() };
+
+	for (const Texture* wallTexture : context.wallTextures)
+	{
+		powerOfTwoTextures = powerOfTwoTextures && wallTexture->isPowerOfTwo();
+		indexedTextures = indexedTextures && wallTexture->isIndexed();
+		anyIndexed = anyIndexed || wallTexture->isIndexed();
+	}
+
+	// An indexed texture has no RGBA pixels left, so the other kernels would read through a null pointer. There is no kernel that
+	// can draw a mix of the two, or indexed textures without a built colormap to shade them with
+	if (anyIndexed && (!indexedTextures || !context.colormap || !context.colormap->isBuilt()))
+	{
+		std::cout << "Error selecting column kernel: " << (indexedTextures ? "indexed textures need a built colormap" : "textures are a mix of indexed and RGBA") << '\n';
+		return nullptr;
+	}
+
+	// Without a view distance the kernel without fog is used, so there isn't a distance check per step and a blend per pixel
+	bool fog{ context.viewDistance > 0.0f };
+
+	return debug ? selectGrid<true>(powerOfTwoGrid, powerOfTwoTextures, indexedTextures, fog, lighting) : selectGrid<false>(powerOfTwoGrid, powerOfTwoTextures, indexedTextures, fog, lighting);
+}
+
+void ColumnBuffer::resize(int columns)
+{
+	rayAngle.resize(columns);
+	rayLength.resize(columns);
+	distance.resize(columns);
+	wallTop.resize(columns);
+	wallBottom.resize(columns);
+	textureId.resize(columns);
+	textureColumn.resize(columns);
+	side.resize(columns);
+	light.resize(columns);
+}
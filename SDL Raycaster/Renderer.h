@@ -0,0 +1,110 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "SDL.h"
+#include "Texture.h"
+#include "Lightmap.h"
+#include "Map.h"
+#include "Palette.h"
+#include <string>
+#include <vector>
+
+// Struct for debugging (holds an intersection point)
+struct point
+{
+	float x{};
+	float y{};
+};
+
+// The points the overhead DEBUG view draws. Only written to by the kernels that were instantiated with debug capture on
+struct DebugCapture
+{
+	std::vector<point> aPoints{};		// Holds intersections with horizontal gridlines
+	std::vector<point> bPoints{};		// Holds intersections with vertical gridlines
+	std::vector<point> actualPoints{};	// Holds the intersection points that are used in rendering
+	std::vector<point> floorPoints{};	// Points where the floor texture is sampled
+};
+
+// How the kernel shades the pixels it draws
+enum class LightingMode
+{
+	FLAT,			// Textures are drawn at full brightness
+	PLAYER_LIGHT,	// The player is a light with a linear falloff
+	BAKED,			// Light is looked up from the lightmap, one value per wall face and floor/ceiling cell
+};
+
+// Where a frame is rendered from. It is a plain value, so poses can be stored, copied and handed to other threads
+struct Camera
+{
+	float x{};						// x-coordinate in pixels, not grid coordinates
+	float y{};						// y-coordinate in pixels, not grid coordinates
+	float theta{};					// Angle the camera is facing
+	int height{};					// Height of the camera above the floor
+	int projectionPlaneCenter{};	// The vertical center of the projection plane. Moving it up and down is how the camera pitches
+};
+
+// What the ray pass found for each column of the screen. Every value has its own array, so a pass that only needs some of them
+// (the depth for sprites, the hit cells for the minimap...) only reads those. The ray pass fills it in and the shading pass reads
+// it, and it stays valid after the frame has been rendered
+struct ColumnBuffer
+{
+	std::vector<float> rayAngle{};		// Angle of the ray on the interval 0 <= rayAngle < 360
+	std::vector<float> rayLength{};		// Distance along the ray to the wall. The lighting uses this one
+	std::vector<float> distance{};		// Distance to the wall corrected for fish-eye. This is the depth buffer
+	std::vector<int> wallTop{};			// Screen row of the top of the wall, before it is clipped to the screen
+	std::vector<int> wallBottom{};		// Screen row just below the bottom of the wall, before it is clipped to the screen
+	std::vector<int> textureId{};		// Index into RenderContext::wallTextures
+	std::vector<int> textureColumn{};	// Column of the wall texture the ray hit (the u coordinate, in texels)
+	std::vector<int8_t> side{};			// The Lightmap::Face the ray hit, or -1 if it left the map without hitting anything
+	std::vector<uint32_t> light{};		// Baked light of the wall face. Only filled in with LightingMode::BAKED
+
+	void resize(int columns);
+};
+
+// Everything the column kernel reads while casting a frame. The map and textures are set up once at startup, and the camera
+// is updated every frame. The map can still be edited between frames
+struct RenderContext
+{
+	const Map* gridMap{};
+	int gridWidth{};
+	int gridHeight{};
+	int gridSize{};
+	int gridShift{ -1 };	// log2 of gridSize, or -1 if gridSize isn't a power of two
+
+	std::vector<const Texture*> wallTextures{};	// Indexed by the texture ID of each wall cell
+	const Texture* floorTexture{};
+	const Texture* ceilingTexture{};
+
+	const Lightmap* lightmap{};	// Only needed for LightingMode::BAKED
+	const Colormap* colormap{};	// Only needed if the textures are indexed, and has to be built
+
+	Camera camera{};
+	int distanceToProjectionPlane{};
+	float adjustedDistanceToProjectionPlane{};
+
+	// Fog. Everything at viewDistance or further away is fogColor, and rays stop looking for walls there. Between fogStart and
+	// viewDistance things fade into the fog. A viewDistance of 0 turns the fog off and lets rays go all the way to the edge of the
+	// map. The kernel is picked with or without fog, so turning it on or off means picking the kernel again, but the distances can
+	// change every frame
+	float viewDistance{};
+	float fogStart{};
+	uint32_t fogColor{ 0x000000FF };
+
+	uint32_t* screen{};
+	int width{};
+	int height{};
+	int pitch{};				// Pixels from the start of one row of screen to the next. 0 means the rows are width pixels long
+	ColumnBuffer* columns{};	// Has to have an entry for every column of the screen
+
+	DebugCapture* debug{};
+};
+
+// Renders the columns firstColumn <= x < lastColumn of the screen
+using ColumnRenderer = void (*)(const RenderContext& context, int firstColumn, int lastColumn);
+
+// Picks the version of the kernel that was compiled for this combination of settings. The grid size and texture dimensions are
+// read from the context, so it should be called once the map and textures are loaded. If no kernel can draw the textures (some
+// are indexed and some aren't, or they are indexed and the colormap is missing or unbuilt) it returns null
+ColumnRenderer selectColumnRenderer(const RenderContext& context, bool debug, LightingMode lighting);
+
+#endif
@@ -0,0 +1,213 @@
+#include "Reprojection.h"
+#include "Angles.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Turns bigger than this (in degrees) are rendered from scratch. There would be too few columns left to reuse to be worth it
+	const float maxTurn{ 15.0f };
+
+	// The difference between two angles, on the interval -180 < difference <= 180
+	inline float angleDifference(float a, float b)
+	{
+		float difference{ fmodf(a - b, 360.0f) };
+
+		if (difference > 180.0f)
+			difference -= 360.0f;
+		else if (difference <= -180.0f)
+			difference += 360.0f;
+
+		return difference;
+	}
+
+	void copyColumn(const ColumnBuffer& from, int fromX, ColumnBuffer& to, int toX)
+	{
+		to.rayAngle[toX] = from.rayAngle[fromX];
+		to.rayLength[toX] = from.rayLength[fromX];
+		to.distance[toX] = from.distance[fromX];
+		to.wallTop[toX] = from.wallTop[fromX];
+		to.wallBottom[toX] = from.wallBottom[fromX];
+		to.textureId[toX] = from.textureId[fromX];
+		to.textureColumn[toX] = from.textureColumn[fromX];
+		to.side[toX] = from.side[fromX];
+		to.light[toX] = from.light[fromX];
+	}
+}
+
+Reprojector::Reprojector(ColumnRenderer renderColumns, int refreshInterval, float maxError, float maxStretch)
+	: m_renderColumns{ renderColumns }, m_refreshInterval{ refreshInterval }, m_maxError{ maxError }, m_maxStretch{ maxStretch }
+{
+
+}
+
+bool Reprojector::findSources(const RenderContext& context)
+{
+	const Camera& camera{ context.camera };
+	const int width{ context.width };
+
+	if (!m_hasPrevious || m_framesSinceRefresh >= m_refreshInterval || context.columns != m_columnsUsed)
+		return false;
+
+	if (static_cast<int>(m_previousScreen.size()) != width * context.height)
+		return false;
+
+	// The debug points of the last frame are needed to fill in the ones of the reused columns
+	if (context.debug && static_cast<int>(m_previousDebug.aPoints.size()) != width)
+		return false;
+
+	// Anything but a turn changes what the rays hit, or where on the screen it is drawn
+	if (camera.x != m_previousCamera.x || camera.y != m_previousCamera.y || camera.height != m_previousCamera.height ||
+		camera.projectionPlaneCenter != m_previousCamera.projectionPlaneCenter)
+		return false;
+
+	float turn{ angleDifference(camera.theta, m_previousCamera.theta) };
+	if (fabsf(turn) > maxTurn)
+		return false;
+
+	// Angle between two columns in the middle of the screen, where they are the furthest apart
+	float columnAngle{ degrees(atanf(1.0f / context.adjustedDistanceToProjectionPlane)) };
+	float tolerance{ m_maxError * columnAngle };
+
+	m_sources.assign(width, -1);
+
+	for (int x{ 0 }; x < width; x++)
+	{
+		// The same angles the kernel uses for this column
+		float angleBetween{ degrees(atanf(static_cast<float>(x - (width / 2)) / context.adjustedDistanceToProjectionPlane)) };
+		float rayAngle{ camera.theta - angleBetween };
+
+		// The column of the last frame whose ray would point this way, if it had been cast exactly. The angles the old columns
+		// actually have are checked around it, so columns which were reused last frame (and are a bit off) aren't trusted blindly
+		float previousX{ width / 2 + context.adjustedDistanceToProjectionPlane * tanf(radians(angleBetween - turn)) };
+		int nearest{ static_cast<int>(floorf(previousX + 0.5f)) };
+
+		float bestError{ tolerance };
+		for (int candidate{ std::max(nearest - 1, 0) }; candidate <= std::min(nearest + 1, width - 1); candidate++)
+		{
+			float error{ fabsf(angleDifference(m_previousColumns.rayAngle[candidate], rayAngle)) };
+
+			// Walls and floors are scaled by the cosine of the angle from the center of the screen, so a column that was rendered
+			// somewhere else comes out too tall or too short
+			float stretch{ fabsf(cosf(radians(angleBetween)) / cosf(radians(m_previousRenderedAt[candidate])) - 1.0f) };
+
+			if (error <= bestError && stretch <= m_maxStretch)
+			{
+				bestError = error;
+				m_sources[x] = candidate;
+			}
+		}
+	}
+
+	return true;
+}
+
+void Reprojector::renderColumns(const RenderContext& context, int firstColumn, int lastColumn)
+{
+	const int width{ context.width };
+
+	// The floor points are only a list, so to know which column they belong to the columns are rendered one by one
+	if (context.debug)
+	{
+		for (int x{ firstColumn }; x < lastColumn; x++)
+		{
+			m_floorPointsFrom[x] = context.debug->floorPoints.size();
+			m_renderColumns(context, x, x + 1);
+		}
+	}
+	else
+		m_renderColumns(context, firstColumn, lastColumn);
+
+	for (int x{ firstColumn }; x < lastColumn; x++)
+		m_renderedAt[x] = degrees(atanf(static_cast<float>(x - (width / 2)) / context.adjustedDistanceToProjectionPlane));
+}
+
+void Reprojector::copyDebugPoints(DebugCapture& debug, int fromX, int toX)
+{
+	debug.aPoints[toX] = m_previousDebug.aPoints[fromX];
+	debug.bPoints[toX] = m_previousDebug.bPoints[fromX];
+	debug.actualPoints[toX] = m_previousDebug.actualPoints[fromX];
+
+	m_floorPointsFrom[toX] = debug.floorPoints.size();
+	debug.floorPoints.insert(debug.floorPoints.end(), m_previousDebug.floorPoints.begin() + m_previousFloorPointsFrom[fromX],
+		m_previousDebug.floorPoints.begin() + m_previousFloorPointsFrom[fromX + 1]);
+}
+
+void Reprojector::render(const RenderContext& context)
+{
+	const int width{ context.width };
+	const int height{ context.height };
+	const int pitch{ context.pitch > 0 ? context.pitch : width };
+	uint32_t* screen{ context.screen };
+
+	int reused{ 0 };
+
+	m_renderedAt.resize(width);
+	m_floorPointsFrom.resize(width + 1);
+
+	// The context's buffer still holds the last frame. Trade it for the one from the frame before, which is about to be written
+	// over anyway
+	m_previousColumns.resize(width);
+	std::swap(m_previousColumns, *context.columns);
+
+	if (findSources(context))
+	{
+		m_framesSinceRefresh++;
+
+		// Columns are done left to right, so the floor points end up in column order
+		int x{ 0 };
+		while (x < width)
+		{
+			int source{ m_sources[x] };
+
+			if (source >= 0)
+			{
+				for (int y{ 0 }; y < height; y++)
+					screen[y * pitch + x] = m_previousScreen[y * width + source];
+
+				copyColumn(m_previousColumns, source, *context.columns, x);
+				m_renderedAt[x] = m_previousRenderedAt[source];
+
+				if (context.debug)
+					copyDebugPoints(*context.debug, source, x);
+
+				reused++;
+				x++;
+				continue;
+			}
+
+			// Render the columns which couldn't be reused, a run of neighboring columns at a time
+			int first{ x };
+			while (x < width && m_sources[x] < 0)
+				x++;
+
+			renderColumns(context, first, x);
+		}
+	}
+	else
+	{
+		m_framesSinceRefresh = 0;
+		renderColumns(context, 0, width);
+	}
+
+	m_reusedFraction = static_cast<float>(reused) / width;
+
+	// Keep this frame around for the next one. The column buffer already is
+	m_previousScreen.resize(width * height);
+	for (int y{ 0 }; y < height; y++)
+		std::copy(screen + y * pitch, screen + y * pitch + width, m_previousScreen.begin() + y * width);
+	std::swap(m_previousRenderedAt, m_renderedAt);
+	m_previousCamera = context.camera;
+	m_columnsUsed = context.columns;
+	m_hasPrevious = true;
+
+	if (context.debug)
+	{
+		m_floorPointsFrom[width] = context.debug->floorPoints.size();
+		m_previousDebug = *context.debug;
+		std::swap(m_previousFloorPointsFrom, m_floorPointsFrom);
+	}
+	else
+		m_previousDebug = DebugCapture{};
+}
@@ -0,0 +1,59 @@
+#ifndef REPROJECTION_H
+#define REPROJECTION_H
+
+#include "Renderer.h"
+#include <vector>
+
+// Reuses columns of the previous frame when the camera has only turned. A ray's hit and the pixels drawn for it only depend on
+// where the camera is and which way the ray points, so after a small turn most of this frame's rays point (almost) the same way as
+// one of last frame's, and that column can be copied instead of cast and shaded again. Only the columns the turn uncovered are
+// rendered. Reused columns are up to maxError columns off in angle. The fish-eye correction of a copied column is still the one for
+// where it was rendered, so a column is only copied while that stretches it by less than maxStretch, and every refreshInterval
+// frames everything is rendered again to keep the error from sticking around. With debug capture on, the reused columns get the
+// debug points of the columns they were copied from. The camera hasn't moved, so those are the points their rays would hit
+class Reprojector
+{
+private:
+	ColumnRenderer m_renderColumns{};
+	int m_refreshInterval{};
+	float m_maxError{};
+	float m_maxStretch{};
+
+	// The last frame that was rendered. The column buffer is swapped with the context's at the start of each frame instead of
+	// being copied, so it has to be the same buffer every frame, and left alone in between
+	std::vector<uint32_t> m_previousScreen{};
+	ColumnBuffer m_previousColumns{};
+	const ColumnBuffer* m_columnsUsed{};
+	std::vector<float> m_previousRenderedAt{};	// Angle from the center of the screen each column was actually rendered at
+	std::vector<float> m_renderedAt{};			// The same for the frame being rendered
+	Camera m_previousCamera{};
+	bool m_hasPrevious{ false };
+	int m_framesSinceRefresh{ 0 };
+
+	// The debug points of the last frame. Column x's floor points are floorPoints[m_previousFloorPointsFrom[x]] up to
+	// floorPoints[m_previousFloorPointsFrom[x + 1]]
+	DebugCapture m_previousDebug{};
+	std::vector<size_t> m_previousFloorPointsFrom{};
+	std::vector<size_t> m_floorPointsFrom{};
+
+	std::vector<int> m_sources{};	// Column of the previous frame each column is copied from, or -1 if it has to be rendered
+	float m_reusedFraction{ 0.0f };
+
+	bool findSources(const RenderContext& context);
+	void renderColumns(const RenderContext& context, int firstColumn, int lastColumn);
+	void copyDebugPoints(DebugCapture& debug, int fromX, int toX);
+
+public:
+	Reprojector(ColumnRenderer renderColumns, int refreshInterval = 8, float maxError = 0.5f, float maxStretch = 0.02f);
+
+	// Render a whole frame into context.screen and context.columns, reusing what it can from the last one
+	void render(const RenderContext& context);
+
+	// The next frame is rendered from scratch. Call it when something other than the camera changed, like the map or the lights
+	void invalidate() { m_hasPrevious = false; }
+
+	// Fraction of the columns of the last frame which were copied instead of rendered
+	float reusedFraction() const { return m_reusedFraction; }
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "SDL.h"
 #include "SDL_image.h"
 #include <iostream>
+#include <unordered_map>
 
 Texture::Texture(const std::string& fileName, int pixelFormat)
 {
@@ -10,6 +11,8 @@ Texture::Texture(const std::string& fileName, int pixelFormat)
 
 	m_width = formattedSurface->w;
 	m_height = formattedSurface->h;
+	m_widthShift = powerOfTwoShift(m_width);
+	m_heightShift = powerOfTwoShift(m_height);
 	m_pixels = new uint32_t[m_width * m_height];
 
 	SDL_LockSurface(formattedSurface);
@@ -28,15 +31,49 @@ Texture::Texture(const std::string& fileName, int pixelFormat)
 Texture::~Texture()
 {
 	delete[] m_pixels;
+	delete[] m_indices;
 }
 
-uint32_t Texture::operator[](int i)
+uint32_t Texture::operator[](int i) const
 {
 	if (i >= 0 && i < m_width * m_height)
-		return m_pixels[i];
+		return isIndexed() ? (*m_palette)[m_indices[i]] : m_pixels[i];
 	else
 	{
 		// std::cout << "Out of bounds error: " << i << "\n";
 		return 0xFFFF00FF;
 	}
+}
+
+uint8_t Texture::index(int i) const
+{
+	if (i >= 0 && i < m_width * m_height)
+		return m_indices[i];
+	else
+		return 0;
+}
+
+void Texture::makeIndexed(const Palette& palette)
+{
+	if (isIndexed())
+		return;
+
+	m_indices = new uint8_t[m_width * m_height];
+	m_palette = &palette;
+
+	// Textures reuse a lot of colors, so only search the palette once per distinct color
+	std::unordered_map<uint32_t, uint8_t> nearest{};
+
+	for (int i{ 0 }; i < m_width * m_height; i++)
+	{
+		auto found{ nearest.find(m_pixels[i]) };
+
+		if (found == nearest.end())
+			found = nearest.emplace(m_pixels[i], palette.nearest(m_pixels[i])).first;
+
+		m_indices[i] = found->second;
+	}
+
+	delete[] m_pixels;
+	m_pixels = nullptr;
 }
\ No newline at end of file
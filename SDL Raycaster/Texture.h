@@ -2,23 +2,54 @@
 #define TEXTURE_H
 
 #include "SDL.h"
+#include "Palette.h"
 #include <iostream>
 
+// Returns log2(value) if value is a power of two, otherwise -1. Used to decide whether divisions by a size can be done with shifts
+inline int powerOfTwoShift(int value)
+{
+	if (value <= 0 || (value & (value - 1)) != 0)
+		return -1;
+
+	int shift{ 0 };
+	while ((1 << shift) != value)
+		shift++;
+
+	return shift;
+}
 
 class Texture
 {
 private:
 	uint32_t* m_pixels{};
+	uint8_t* m_indices{};			// Palette indices. Only used once the texture has been made indexed, and replaces m_pixels
+	const Palette* m_palette{};
 
 public:
 	int m_width;
 	int m_height;
+	int m_widthShift;	// log2 of m_width, or -1 if the width isn't a power of two
+	int m_heightShift;	// log2 of m_height, or -1 if the height isn't a power of two
 
 	Texture(const std::string& fileName, int pixelFormat);
 	~Texture();
 
-	uint32_t operator[](int i);
+	uint32_t operator[](int i) const;
+
+	// Palette index of a pixel. Only valid for indexed textures
+	uint8_t index(int i) const;
+
+	// Swap the 32-bit pixels for 8-bit indices into the palette, using a quarter of the memory. The palette has to outlive the texture
+	void makeIndexed(const Palette& palette);
+
+	bool isIndexed() const { return m_indices != nullptr; }
+
+	// True if both dimensions are powers of two, meaning texture coordinates can be wrapped with a mask instead of bounds checked
+	bool isPowerOfTwo() const { return m_widthShift >= 0 && m_heightShift >= 0; }
+
+	// Unchecked access to the pixels, for render loops that have already clamped or masked their coordinates
+	const uint32_t* pixels() const { return m_pixels; }
+	const uint8_t* indices() const { return m_indices; }
 };
 
 #endif
-
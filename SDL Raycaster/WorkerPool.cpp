@@ -0,0 +1,81 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threads)
+{
+	int threadCount{ threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency()) };
+
+	// The thread calling run() works too, so one fewer has to be started
+	for (int i{ 1 }; i < threadCount; i++)
+		m_workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard{ m_lock };
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+void WorkerPool::run(int pieces, const std::function<void(int)>& task)
+{
+	// Not worth waking anybody up for
+	if (m_workers.empty() || pieces <= 1)
+	{
+		for (int i{ 0 }; i < pieces; i++)
+			task(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard{ m_lock };
+		m_task = &task;
+		m_pieces = pieces;
+		m_nextPiece = 0;
+		m_working = static_cast<int>(m_workers.size());
+		m_job++;
+	}
+	m_wake.notify_all();
+
+	work();
+
+	// The task lives on the caller's stack, so it can't be returned from until every worker is done with it
+	std::unique_lock<std::mutex> guard{ m_lock };
+	m_finished.wait(guard, [this]() { return m_working == 0; });
+	m_task = nullptr;
+}
+
+void WorkerPool::work()
+{
+	for (int i{ m_nextPiece++ }; i < m_pieces; i = m_nextPiece++)
+		(*m_task)(i);
+}
+
+void WorkerPool::workerLoop()
+{
+	uint64_t lastJob{ 0 };
+
+	std::unique_lock<std::mutex> guard{ m_lock };
+
+	while (true)
+	{
+		m_wake.wait(guard, [this, lastJob]() { return m_stopping || m_job != lastJob; });
+
+		if (m_stopping)
+			return;
+
+		lastJob = m_job;
+
+		guard.unlock();
+		work();
+		guard.lock();
+
+		if (--m_working == 0)
+			m_finished.notify_one();
+	}
+}
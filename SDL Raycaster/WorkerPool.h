@@ -0,0 +1,49 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads which are started once and then wait for work, for jobs that are split across threads every frame (the extra views, batches
+// of ray queries). Starting and joining threads each time would cost more than some of those jobs take. A job is split into pieces,
+// and every thread (including the one that called run()) keeps taking the next piece until there are none left
+class WorkerPool
+{
+private:
+	std::vector<std::thread> m_workers{};
+
+	// Shared with the workers. The job is only changed with m_lock held, while no worker is working on it
+	std::mutex m_lock{};
+	std::condition_variable m_wake{};		// A new job has been started, or the pool is stopping
+	std::condition_variable m_finished{};	// The last worker has finished its share of the job
+	const std::function<void(int)>* m_task{};
+	int m_pieces{ 0 };
+	std::atomic<int> m_nextPiece{ 0 };
+	int m_working{ 0 };		// Workers which haven't finished with the current job yet
+	uint64_t m_job{ 0 };	// Counts the jobs, so a worker can tell a new job from the one it just finished
+	bool m_stopping{ false };
+
+	void workerLoop();
+	void work();
+
+public:
+	// threads is the number of threads working on each job, counting the one that calls run(), or 0 for one per core
+	explicit WorkerPool(int threads = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	int threadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+	// Call task(i) for every 0 <= i < pieces, spread over the threads, and return once every call has finished. Only one thread
+	// should call run() at a time
+	void run(int pieces, const std::function<void(int)>& task);
+};
+
+#endif
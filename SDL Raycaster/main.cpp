@@ -7,10 +7,24 @@
 #include "SDL_ttf.h"
 #include "SDL_mixer.h"
 #include <vector>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
 
 // Headers created by me which contain useful classes
+#include "Angles.h"
 #include "Texture.h"
 #include "Sprite.h"
+#include "Renderer.h"
+#include "Collision.h"
+#include "Batch.h"
+#include "RayQuery.h"
+#include "OverheadView.h"
+#include "Reprojection.h"
+#include "MultiView.h"
+#include "ChunkedWorld.h"
+#include "FrameCapture.h"
 
 // Size of the screen which the raycast scene is projected to (doesn't include the map)
 const int width = 640;
@@ -20,12 +34,34 @@ int projectionPlaneCenter{ height / 2 };	// The vertical center of the projectio
 
 bool DEBUG{ false };	// Set equal to true for an overhead view of the scene
 
-float zBuffer[width];	// Holds the depth value of the wall for each column
+LightingMode lightingMode{ LightingMode::PLAYER_LIGHT };	// How the walls, floor and ceiling are shaded
+bool indexedTextures{ false };	// Set equal to true to store the textures as 8-bit palette indices and shade them with a colormap
+bool temporalReprojection{ false };	// Set equal to true to reuse the columns of the last frame when the player only turns
+bool rearView{ false };				// Set equal to true to draw what is behind the player in a strip at the top of the screen
+
+float viewDistance{ 0.0f };			// How far the player can see before everything is fog. 0 turns the fog off
+uint32_t fogColor{ 0x000000FF };	// Color that things in the distance fade into
+bool adaptiveViewDistance{ false };	// Set equal to true to pull the fog in when frames take too long to render, and push it back out when they don't
+float renderBudget{ 0.008f };		// Seconds the adaptive view distance tries to keep rendering a frame under
+
+bool recording{ false };			// Set equal to true to record from the first frame. R starts and stops recording while playing
+// Where recordings go and what happens when the disk can't keep up. Each recording adds its number to the end of output
+CaptureSettings captureSettings{ "capture", false, CapturePolicy::DROP, 8 };
+
 
 int gridSize{ 64 };		// Side length of an individual grid block
 int gridWidth{ 20 };	// Width of the whole map in terms of grid blocks
 int gridHeight{ 20 };	// Height of the whole map in terms of grid blocks
-std::string gridMap{};	// String which stores the map
+// Static lights in the map. These are baked into the lightmap when the map is loaded, and only used with LightingMode::BAKED
+std::vector<Light> lights{
+	{ 96.0f, 96.0f, 48.0f, 448.0f, 0xFFC080FF, 1.2f },		// Warm light in the top left room
+	{ 928.0f, 224.0f, 48.0f, 576.0f, 0x80A0FFFF, 1.0f },	// Blue light in the top right room
+	{ 672.0f, 672.0f, 48.0f, 384.0f, 0xFFFFFFFF, 0.8f },
+	{ 160.0f, 1056.0f, 48.0f, 448.0f, 0xFF4040FF, 1.0f },	// Red light in the bottom left
+	{ 928.0f, 992.0f, 48.0f, 576.0f, 0x60FF60FF, 1.0f },	// Green light in the bottom right room
+};
+
+uint32_t ambientLight{ 0x30303000 };	// Light every surface gets, even if no light reaches it
 
 // std::vector<Sprite> sprite{ {"Best Resume Photo No background.png", SDL_PIXELFORMAT_RGBA8888, 320.0f, 320.0f} };
 
@@ -61,17 +97,8 @@ float FPS{};
 //std::vector<float> iTanTable(360 / FOV * width);
 //std::vector<float> fishEyeTable(width);
 
-// Struct for debugging (holds an intersection point)
-struct point
-{
-	float x{};
-	float y{};
-};
-
-std::vector<point> aPoints(width);		// Holds intersections with horizontal gridlines
-std::vector<point> bPoints(width);		// Holds intersections with vertical gridlines
-std::vector<point> actualPoints(width);	// Holds the intersection points that are used in rendering
-std::vector<point> floorPoints{};		// Points where the floor texture is sampled
+// Holds the intersection points for the overhead view (only filled in when DEBUG is true)
+DebugCapture debugCapture{ std::vector<point>(width), std::vector<point>(width), std::vector<point>(width), {} };
 
 
 // In RGBA format
@@ -86,51 +113,18 @@ enum Color
 	WHITE = 0xFFFFFFFF,
 };
 
-// Convert an angle from degrees to radians (needed for use with trigonometric functions)
-float radians(float degrees)
+// Shut down SDL and its libraries and free the screen. Every way out of main() goes through here. Returns exitCode, so it can be
+// returned straight from main()
+int shutDown(uint32_t* screen, int exitCode)
 {
-	return static_cast<float>(degrees * (M_PI / 180.0f));
-}
-
-float degrees(float radians)
-{
-	return static_cast<float>(radians * (180.0f / M_PI));
-}
+	SDL_Quit();
+	IMG_Quit();
+	TTF_Quit();
+	Mix_Quit();
 
-// Restrict angles to 0 - 360 degrees
-float getCoterminalAngle(float angle)
-{
-	if (angle < 0.0f)
-	{
-		while (angle < 0)
-		{
-			angle += 360.0f;
-		}
-		return angle;
-	}
-	else if (angle >= 360.0f)
-		return angle - (static_cast<int>(angle / 360) * 360);
-	else return angle;
-}
+	delete[] screen;
 
-uint32_t calculateLighting(const uint32_t& color, const float& lighting)
-{
-	uint32_t red{ color >> 24 };
-	uint32_t green{ (color >> 16) - (red << 8) };
-	uint32_t blue{ (color >> 8) - (red << 16) - (green << 8) };
-
-	// Calculate the brightness of each color according to the lighting
-	red = static_cast<uint32_t>(red * 0.0039215686f * lighting);
-	green = static_cast<uint32_t>(green * 0.0039215686f * lighting);
-	blue = static_cast<uint32_t>(blue * 0.0039215686f * lighting);
-
-	// Move the compontents to their original hex positions
-	red <<= 24;
-	green <<= 16;
-	blue <<= 8;
-
-	// Create a new color from the components and output it to the screen
-	return uint32_t{ red + green + blue + 0x000000FF };
+	return exitCode;
 }
 
 int main(int argc, char* argv[])
@@ -152,6 +146,192 @@ int main(int argc, char* argv[])
 	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0)
 		std::cout << "Error opening Mix: " << Mix_GetError() << '\n';
 
+	uint32_t* screen = new uint32_t[width * height];	// An array of pixels that is manipulated then updated to frameBuffer
+
+	Texture wallTexture{ "redbrick.png", SDL_PIXELFORMAT_RGBA8888 };
+	Texture doorTexture{ "bullseye.png", SDL_PIXELFORMAT_RGBA8888 };
+	Texture floorTexture{ "colorstone.png", SDL_PIXELFORMAT_RGBA8888 };
+	Texture ceilingTexture{ "wood.png", SDL_PIXELFORMAT_RGBA8888 };
+
+	// Build one palette for all of the textures, then convert them to indices into it
+	Palette palette{};
+	Colormap colormap{};
+	if (indexedTextures)
+	{
+		palette.build({ &wallTexture, &doorTexture, &floorTexture, &ceilingTexture });
+		colormap.build(palette);
+
+		wallTexture.makeIndexed(palette);
+		doorTexture.makeIndexed(palette);
+		floorTexture.makeIndexed(palette);
+		ceilingTexture.makeIndexed(palette);
+	}
+
+	// Create the map. 'D' is a door, which has to be between two walls
+	std::string mapLayout{};
+	mapLayout += "####################";
+	mapLayout += "#--------##--------#";
+	mapLayout += "#####D#####--------#";
+	mapLayout += "#------------------#";
+	mapLayout += "#------------------#";
+	mapLayout += "#-##---#-##--------#";
+	mapLayout += "#-##-----##--------#";
+	mapLayout += "#--------##--------#";
+	mapLayout += "#--####--##--------#";
+	mapLayout += "##########--########";
+	mapLayout += "########---#########";
+	mapLayout += "#---#----##--------#";
+	mapLayout += "#-#---#########D####";
+	mapLayout += "#####-----#--------#";
+	mapLayout += "#-----#------------#";
+	mapLayout += "##-#-##--##-##---#-#";
+	mapLayout += "#--#-###-##-##-----#";
+	mapLayout += "#-##--#--##--------#";
+	mapLayout += "#--####--##--####--#";
+	mapLayout += "####################";
+
+	// Write a world file of generated rooms, which can be much bigger than memory, then quit:
+	//	"SDL Raycaster" --make-world <world file> <width> <height> [seed]
+	if (argc >= 5 && std::string{ argv[1] } == "--make-world")
+	{
+		unsigned int seed{ argc >= 6 ? static_cast<unsigned int>(std::atoi(argv[5])) : 1u };
+		bool succeeded{ ChunkedWorld::generate(argv[2], std::atoi(argv[3]), std::atoi(argv[4]), seed) };
+
+		return shutDown(screen, succeeded ? 0 : 1);
+	}
+
+	// Play a world streamed in from a world file instead of the map above:
+	//	"SDL Raycaster" --world <world file>
+	std::unique_ptr<ChunkedWorld> world{};
+	if (argc >= 3 && std::string{ argv[1] } == "--world")
+	{
+		world = std::make_unique<ChunkedWorld>(argv[2]);
+		if (!world->isOpen())
+		{
+			return shutDown(screen, 1);
+		}
+
+		// The map becomes a window onto the world, which is all walls until the chunks are loaded
+		gridWidth = WorldWindow::WINDOW_CELLS;
+		gridHeight = WorldWindow::WINDOW_CELLS;
+		mapLayout = std::string(gridWidth * gridHeight, Map::WALL);
+
+		// The static lights were placed for the map above
+		lights.clear();
+	}
+
+	// Holds the map, along with the texture of each block and the state of the doors
+	Map gridMap{ mapLayout, gridWidth, gridHeight, gridSize };
+
+	// Keeps the map filled with the part of the world around the player
+	std::unique_ptr<WorldWindow> worldWindow{};
+	if (world)
+	{
+		worldWindow = std::make_unique<WorldWindow>(*world, gridMap);
+
+		int shiftX{};
+		int shiftY{};
+		worldWindow->update(playerX, playerY, theta, shiftX, shiftY);
+	}
+
+	// The player is the first body in the collision world
+	CollisionWorld collisionWorld{};
+	collisionWorld.bodies.push_back(Body{ playerX, playerY, static_cast<float>(playerRadius), 0.0f, 0.0f, playerX, playerY });
+
+	// Bake the static lights. This only has to be done again if the map or the lights change
+	Lightmap lightmap{ gridMap, ambientLight };
+	lightmap.bake(lights);
+
+	// What the ray pass found for each column. The shading pass reads it, and its distances are the depth buffer
+	ColumnBuffer columnBuffer{};
+	columnBuffer.resize(width);
+
+	// Everything the kernel needs that doesn't change from frame to frame
+	RenderContext renderContext{};
+	renderContext.gridMap = &gridMap;
+	renderContext.gridWidth = gridWidth;
+	renderContext.gridHeight = gridHeight;
+	renderContext.gridSize = gridSize;
+	renderContext.gridShift = powerOfTwoShift(gridSize);
+	renderContext.wallTextures = { &wallTexture, &doorTexture };	// Texture IDs 0 and Map::DOOR_TEXTURE
+	renderContext.floorTexture = &floorTexture;
+	renderContext.ceilingTexture = &ceilingTexture;
+	renderContext.lightmap = &lightmap;
+	renderContext.colormap = indexedTextures ? &colormap : nullptr;
+	renderContext.distanceToProjectionPlane = distanceToProjectionPlane;
+	renderContext.adjustedDistanceToProjectionPlane = adjustedDistanceToProjectionPlane;
+	renderContext.viewDistance = viewDistance;
+	renderContext.fogStart = viewDistance * 0.5f;	// Things start fading halfway to the view distance
+	renderContext.fogColor = fogColor;
+	renderContext.screen = screen;
+	renderContext.width = width;
+	renderContext.height = height;
+	renderContext.columns = &columnBuffer;
+	renderContext.debug = &debugCapture;
+
+	// Pick the version of the kernel compiled for these settings. DEBUG, the grid size and the textures don't change while the
+	// game is running, so this only has to happen once
+	ColumnRenderer renderColumns{ selectColumnRenderer(renderContext, DEBUG, lightingMode) };
+	if (!renderColumns)
+	{
+		return shutDown(screen, 1);
+	}
+
+	// Renders with the same kernel, but copies what it can from the last frame
+	Reprojector reprojector{ renderColumns };
+
+	// Render the camera poses in a job file instead of playing, without opening a window:
+	//	"SDL Raycaster" --batch <job file> <output> [--packed] [--threads <count>]
+	if (argc >= 4 && std::string{ argv[1] } == "--batch")
+	{
+		BatchSettings settings{};
+		settings.jobFile = argv[2];
+		settings.output = argv[3];
+
+		for (int i{ 4 }; i < argc; i++)
+		{
+			std::string option{ argv[i] };
+
+			if (option == "--packed")
+				settings.packed = true;
+			else if (option == "--threads" && i + 1 < argc)
+				settings.threads = std::atoi(argv[++i]);
+		}
+
+		bool succeeded{ runBatch(renderContext, lightingMode, settings) };
+
+		return shutDown(screen, succeeded ? 0 : 1);
+	}
+
+	// Time the ray queries used by game logic against this map, without opening a window:
+	//	"SDL Raycaster" --bench-rays [ray count] [threads]
+	if (argc >= 2 && std::string{ argv[1] } == "--bench-rays")
+	{
+		int rayCount{ argc >= 3 ? std::atoi(argv[2]) : 100000 };
+		int threads{ argc >= 4 ? std::atoi(argv[3]) : 1 };
+
+		benchmarkRayQueries(gridMap, std::max(rayCount, 1), std::max(threads, 1));
+
+		return shutDown(screen, 0);
+	}
+
+	// Extra cameras drawn on top of the scene, which share the map and textures with the main view. Their threads are only started
+	// if there is an extra view to draw. The main view is rendered on the same threads as view 0, unless it needs the kernel with
+	// debug capture (which the threads can't share) or goes through the reprojector
+	std::unique_ptr<MultiView> views{};
+	int mainViewIndex{ -1 };
+	int rearViewIndex{ -1 };
+
+	if (rearView)
+	{
+		views = std::make_unique<MultiView>(renderContext, selectColumnRenderer(renderContext, false, lightingMode));
+
+		if (!DEBUG && !temporalReprojection)
+			mainViewIndex = views->addMainView();
+
+		rearViewIndex = views->addView(width / 2 - 120, 8, 240, 80, static_cast<float>(FOV));
+	}
+
 	// SDL_CreateWindow() creates a window
 	//								Window name	  Window X position     Window Y position   width height    flags
 	//									 V			      V						V			   V    V         V
@@ -163,35 +343,13 @@ int main(int argc, char* argv[])
 
 	// Create a blank texture
 	SDL_Texture* frameBuffer{ SDL_CreateTexture(renderTarget, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, width, height) };
-	uint32_t* screen = new uint32_t[width * height];	// An array of pixels that is manipulated then updated to frameBuffer
 
-	const Uint8* keystate{};
+	// The overhead view is drawn into its own pixel array and texture, to the right of the scene. Without DEBUG there is nowhere to
+	// show it, so it isn't made at all
+	std::unique_ptr<OverheadView> overheadView{ DEBUG ? std::make_unique<OverheadView>(gridMap, height) : nullptr };
+	SDL_Texture* overheadBuffer{ DEBUG ? SDL_CreateTexture(renderTarget, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, height, height) : nullptr };
 
-	Texture wallTexture{ "redbrick.png", SDL_PIXELFORMAT_RGBA8888 };
-	Texture floorTexture{ "colorstone.png", SDL_PIXELFORMAT_RGBA8888 };
-	Texture ceilingTexture{ "wood.png", SDL_PIXELFORMAT_RGBA8888 };
-
-	// Create the map
-	gridMap += "####################";
-	gridMap += "#--------##--------#";
-	gridMap += "#####-#####--------#";
-	gridMap += "#------------------#";
-	gridMap += "#------------------#";
-	gridMap += "#-##---#-##--------#";
-	gridMap += "#-##-----##--------#";
-	gridMap += "#--------##--------#";
-	gridMap += "#--####--##--------#";
-	gridMap += "##########--########";
-	gridMap += "########---#########";
-	gridMap += "#---#----##--------#";
-	gridMap += "#-#---#########-####";
-	gridMap += "#####-----#--------#";
-	gridMap += "#-----#------------#";
-	gridMap += "##-#-##--##-##---#-#";
-	gridMap += "#--#-###-##-##-----#";
-	gridMap += "#-##--#--##--------#";
-	gridMap += "#--####--##--####--#";
-	gridMap += "####################";
+	const Uint8* keystate{};
 
 	// Fill the tables with the trig value of each possible ray angles (3600 of them with a 60 degree FOV and width of 600)
 	//for (int i{ 0 }; i < 360 / FOV * width; i++)
@@ -218,6 +376,35 @@ int main(int argc, char* argv[])
 	//}
 
 
+	// Records the frames while recording is on. Each recording gets its own files, and stopping one writes out what is left of it
+	std::unique_ptr<FrameCapture> frameCapture{};
+	int recordingNumber{ 0 };
+
+	auto startRecording{ [&frameCapture, &recordingNumber]()
+	{
+		CaptureSettings settings{ captureSettings };
+		settings.output += std::to_string(++recordingNumber) + (settings.packed ? ".rgb" : "");
+
+		frameCapture = std::make_unique<FrameCapture>(width, height, settings);
+		if (!frameCapture->isOpen())
+			frameCapture.reset();
+	} };
+
+	auto stopRecording{ [&frameCapture]()
+	{
+		if (!frameCapture)
+			return;
+
+		// Stopping writes out the frames that are still queued, so the counts only add up after it
+		frameCapture->stop();
+
+		std::cout << "Recording stopped. " << frameCapture->framesWritten() << " frames written, " << frameCapture->framesFailed() << " failed, " << frameCapture->framesDropped() << " dropped, " << frameCapture->averageOverhead() * 1000.0 << " ms per frame spent capturing\n";
+		frameCapture.reset();
+	} };
+
+	if (recording)
+		startRecording();
+
 	// Game loop
 	while (isRunning)
 	{
@@ -243,6 +430,48 @@ int main(int argc, char* argv[])
 					}
 				}
 				break;
+
+				// Check for keys which should only act once per press
+			case SDL_KEYDOWN:
+				if (ev.key.repeat == 0)
+				{
+					// The block directly in front of the player
+					int frontX{ static_cast<int>((playerX + gridSize * cosf(radians(theta))) / gridSize) };
+					int frontY{ static_cast<int>((playerY - gridSize * sinf(radians(theta))) / gridSize) };
+					bool insideBorder{ frontX > 0 && frontX < gridWidth - 1 && frontY > 0 && frontY < gridHeight - 1 };
+
+					// Start or stop recording
+					if (ev.key.keysym.scancode == SDL_SCANCODE_R)
+					{
+						if (frameCapture)
+							stopRecording();
+						else
+							startRecording();
+					}
+
+					// Open or close the door in front of the player
+					if (ev.key.keysym.scancode == SDL_SCANCODE_E)
+						gridMap.toggleDoor(frontX, frontY);
+
+					// Knock down the wall in front of the player, or build one if there isn't one (the border is left alone)
+					if (ev.key.keysym.scancode == SDL_SCANCODE_F && insideBorder)
+					{
+						// In a chunked world the window remembers the change, or it would be undone the next time the window moves
+						auto setCell{ [&](char cell)
+						{
+							if (worldWindow)
+								worldWindow->setCell(frontX, frontY, cell, 0);
+							else
+								gridMap.setCell(frontX, frontY, cell, 0);
+						} };
+
+						if (gridMap.at(frontX, frontY) == Map::WALL)
+							setCell(Map::EMPTY);
+						else if (gridMap.at(frontX, frontY) == Map::EMPTY && (frontX != static_cast<int>(playerX / gridSize) || frontY != static_cast<int>(playerY / gridSize)))
+							setCell(Map::WALL);
+					}
+				}
+				break;
 			}
 		}
 
@@ -255,32 +484,109 @@ int main(int argc, char* argv[])
 		deltaTime = currentTime - previousTime;
 		FPS = 1.0f / deltaTime;
 
-		// Make a copy of the map so I can put in a character to represent the player without changing the original map
-		std::string mapCopy{ gridMap };
+		// Stream in the part of the world around the player. When the window moves, everything in it has to move back by the
+		// same amount to stay in the same place in the world
+		if (worldWindow)
+		{
+			int shiftX{};
+			int shiftY{};
+			if (worldWindow->update(playerX, playerY, theta, shiftX, shiftY))
+			{
+				for (Body& body : collisionWorld.bodies)
+				{
+					body.x -= static_cast<float>(shiftX * gridSize);
+					body.y -= static_cast<float>(shiftY * gridSize);
+					body.previousX -= static_cast<float>(shiftX * gridSize);
+					body.previousY -= static_cast<float>(shiftY * gridSize);
+				}
+
+				playerX = collisionWorld.bodies[0].x;
+				playerY = collisionWorld.bodies[0].y;
+			}
+		}
+
+		// Move the doors, and relight only the blocks around the cells that were changed. They are relit and redrawn in one go,
+		// since a chunk of the world arriving or the window moving changes thousands of cells at once
+		gridMap.update(deltaTime);
+
+		if (!gridMap.changedCells().empty())
+		{
+			int firstX{ gridWidth };
+			int firstY{ gridHeight };
+			int lastX{ -1 };
+			int lastY{ -1 };
+
+			for (int cell : gridMap.changedCells())
+			{
+				firstX = std::min(firstX, cell % gridWidth);
+				firstY = std::min(firstY, cell / gridWidth);
+				lastX = std::max(lastX, cell % gridWidth);
+				lastY = std::max(lastY, cell / gridWidth);
+			}
+
+			lightmap.relight(firstX, firstY, lastX, lastY);
+			if (overheadView)
+				overheadView->redrawCells(firstX, firstY, lastX, lastY);
+		}
+
+		// Columns of the last frame can't be reused if the map they were cast against has changed
+		if (!gridMap.changedCells().empty() || gridMap.doorsMoving())
+			reprojector.invalidate();
+
+		gridMap.clearChangedCells();
 
 		// Calculate player coordinates in terms of grid squares
 		int gridX{ static_cast<int>(playerX / gridSize) };
 		int gridY{ static_cast<int>(playerY / gridSize) };
 
-		// Put a character to represent the player in the map
-		mapCopy[gridY * gridWidth + gridX] = 'P';
-
 		// Output FPS and angle info
 		std::cout << "FPS: " << FPS << '\n';
 		std::cout << "Angle: " << theta << '\n';
+		std::cout << "Columns reused: " << reprojector.reusedFraction() * 100.0f << "%    \n";
 
-		// Copy the map to the console
-		for (int y{ 0 }; y < gridHeight; y++)
+		int linesWritten{ 3 };
+
+		if (adaptiveViewDistance && viewDistance > 0.0f)
 		{
-			for (int x{ 0 }; x < gridWidth; x++)
+			std::cout << "View distance: " << renderContext.viewDistance << "          \n";
+			linesWritten++;
+		}
+
+		if (frameCapture)
+		{
+			std::cout << "Capture: " << frameCapture->lastOverhead() * 1000.0 << " ms, " << frameCapture->framesDropped() << " dropped, " << frameCapture->framesQueued() << " queued          \n";
+			linesWritten++;
+		}
+
+		// A world is far too big to print, so just say where in it the player is
+		if (worldWindow)
+		{
+			std::cout << "World position: " << worldWindow->originX() + gridX << ", " << worldWindow->originY() + gridY << "          \n";
+			linesWritten++;
+		}
+		else
+		{
+			// Make a copy of the map so I can put in a character to represent the player without changing the original map
+			std::string mapCopy{ gridMap.cells() };
+
+			// Put a character to represent the player in the map
+			mapCopy[gridY * gridWidth + gridX] = 'P';
+
+			// Copy the map to the console
+			for (int y{ 0 }; y < gridHeight; y++)
 			{
-				std::cout << mapCopy[y * gridWidth + x];
+				for (int x{ 0 }; x < gridWidth; x++)
+				{
+					std::cout << mapCopy[y * gridWidth + x];
+				}
+				std::cout << '\n';
 			}
-			std::cout << '\n';
+
+			linesWritten += gridHeight;
 		}
 
-		// Return the cursor in the console to twelve lines above so that old information is written over
-		std::cout << "\x1b[" << 2 + gridHeight << "F";
+		// Return the cursor in the console to the first line written so that old information is written over
+		std::cout << "\x1b[" << linesWritten << "F";
 
 		// Color every pixel in the screen array black
 		for (int i{ 0 }; i < width * height; i++)
@@ -313,8 +619,13 @@ int main(int argc, char* argv[])
 			ySpeed = playerSpeed * sinf(radians(theta));
 		}
 
-		playerX += xSpeed * deltaTime;
-		playerY += ySpeed * deltaTime;
+		// The collision world moves the player (and anything else in it) in fixed steps, sliding along any walls in the way
+		collisionWorld.bodies[0].velocityX = xSpeed;
+		collisionWorld.bodies[0].velocityY = ySpeed;
+		collisionWorld.update(gridMap, deltaTime);
+
+		playerX = collisionWorld.bodies[0].x;
+		playerY = collisionWorld.bodies[0].y;
 
 		// Turn player left and right
 		if (keystate[SDL_SCANCODE_A])
@@ -344,476 +655,72 @@ int main(int argc, char* argv[])
 		else if (playerHeight <= 0)
 			playerHeight = 1;
 
-		int playerGridOffsetX{ static_cast<int>(playerX) - (gridX * gridSize) };
-		int playerGridOffsetY{ static_cast<int>(playerY) - (gridY * gridSize) };
-
-		if (xSpeed < 0.0f)
-		{
-			if (gridMap[gridY * gridWidth + (gridX - 1)] == '#' && playerGridOffsetX < playerRadius)
-				playerX -= xSpeed * deltaTime;
-		}
-		else
-		{
-			if (gridMap[gridY * gridWidth + (gridX + 1)] == '#' && gridSize - playerGridOffsetX < playerRadius)
-				playerX -= xSpeed * deltaTime;
-		}
-
-		if (ySpeed < 0.0f)
-		{
-			if (gridMap[(gridY - 1) * gridWidth + gridX] == '#' && playerGridOffsetY < playerRadius)
-				playerY -= ySpeed * deltaTime;
-		}
-		else
-		{
-			if (gridMap[(gridY + 1) * gridWidth + gridX] == '#' && gridSize - playerGridOffsetY < playerRadius)
-				playerY -= ySpeed * deltaTime;
-		}
-
 		if(DEBUG)
-			floorPoints.clear();
+			debugCapture.floorPoints.clear();
 
-		// Send a ray out into the scene for each vertical row of pixels in the screen array
-		for (int x{ 0 }; x < width; x++)
+		// The player carries a light around with them. Only the cells near the player are relit, instead of the whole map
+		if (lightingMode == LightingMode::BAKED)
 		{
-			// theta + FOV * 0.5 is the angle of the first ray at the far left
-			// FOV / width is the angle between the rays
-			// * x is to determine the angle of the current ray
-			// float rayAngle{ (theta + FOV * 0.5f) - (static_cast<float>(FOV) / width) * static_cast<float>(x) };
-
-			// Calculate the angle between two rays
-			float angleBetween{ degrees(atanf(static_cast<float>(x - (width / 2)) / adjustedDistanceToProjectionPlane)) };
-
-			// Find the angle of the ray
-			float rayAngle{ theta - angleBetween };
-
-			// Precalculate the value of tan of rayAngle because that value is used eight times
-			float tanOfRayAngle{ tanf(radians(rayAngle)) };
-
-			// Find the angle of the ray on the interval 0 <= rayAngle < 360
-			rayAngle = getCoterminalAngle(rayAngle);
-
-			if (rayAngle == 360.0f)
-				rayAngle = 0.0f;
-
-			//// Calculates the correct index for the look up tables
-			// int i{ static_cast<int>(width * rayAngle / FOV) };
-
-			// These two boolean values are used to determine how to texture the wall by determining which side of the wall the ray hit
-			bool topOrBottom{};	// True means the ray hit the top of the wall, false means it hit the bottom
-			bool leftOrRight{};	// True means the ray hit the left of the wall, false means it hit the right
-
-			// CALCULATE HORIZONTAL INTERSECTIONS
-			float horizontalIntersectionsDistance{ -1.0f };
-
-			// Point A is the point of the first intersection between the ray and the horizontal grid lines
-			float aX{};
-			float aY{};
-
-			// The change between point A and the next intersection with the horizontal grid lines
-			float dx{};
-			float dy{};
-
-			// If the ray is facing up... (or downwards on the coordinate grid)
-			if (rayAngle < 180)
-			{
-				// Because the ray is pointing up, that means it will hit the bottoms of the wall
-				topOrBottom = false;
-
-				// The first intersection will be part of the grid below (calculates y-coordinate of grid line below)
-				aY = floorf(playerY / static_cast<float>(gridSize)) * gridSize;
-
-				// The next intersection with a horizontal grid line will be gridSize units below
-				dy = -static_cast<float>(gridSize);
-
-				//	      90					90		
-				//  -x,-y | +x,-y			-tan | +tan
-				// 180 ---+--- 0		  180 ---+--- 0	
-				//	-x,+y |	+x,+y			+tan | -tan
-				//		 270				    270		
-				// When rayAngle < 90, dx should be >0, and when rayAngle > 90, dx should be <0
-				// It just so happens that tan is >0 when rayAngle < 90 degrees, and tan is <0 when rayAngle > 90
-				// so I don't have to change the signs at all
-				dx = gridSize / tanOfRayAngle;
-
-				// Calculate the x-coordinate of the first intersection with a horizontal gridline
-				aX = playerX - (aY - playerY) / tanOfRayAngle;
-
-				// Make part of the grid below for ease of checking for a wall
-				aY--;
-			}
-			// If ray is facing down... (or upwards on the coordinate grid)
-			else
-			{
-				// The ray is facing down, so the ray hits the top of the wall
-				topOrBottom = true;
-
-				// The first horizontal grid intersection is with the grid line above the player
-				aY = floorf(playerY / static_cast<float>(gridSize)) * gridSize + gridSize;
-
-				// The next gridline with be gridSize units above the player
-				dy = static_cast<float>(gridSize);
-
-				//	      90					90		
-				//  -x,-y | +x,-y			-tan | +tan
-				// 180 ---+--- 0		  180 ---+--- 0	
-				//	-x,+y |	+x,+y			+tan | -tan
-				//		 270				    270		
-				// When rayAngle < 270, dx should be <0, and when rayAngle > 270, dx should be >0
-				// It just so happens that tan is >0 when rayAngle < 270 degrees, and tan is <0 when rayAngle > 270
-				// so I have to flip the signs with the negative
-				dx = -gridSize / tanOfRayAngle;
-
-				// Calculate the x-coordinate of the first intersection with a horizontal gridline
-				aX = playerX - (aY - playerY) / tanOfRayAngle;
-			}
-
-			// Grid coordinates of point A
-			int aXgrid{ static_cast<int>(aX / gridSize) };
-			int aYgrid{ static_cast<int>(aY / gridSize) };
-
-			// So long as the x-coordinate in terms of the grid of A is within the bounds of the map...
-			if (!(aXgrid < 0 || aXgrid >= gridWidth))
-			{
-				// If there is a wall in that grid, calculate the distance
-				if (gridMap[aYgrid * gridWidth + aXgrid] == '#')
-				{
-					horizontalIntersectionsDistance = sqrtf((playerX - aX) * (playerX - aX) + (playerY - aY) * (playerY - aY));
-				}
-			}
-			// If the x-coordinate in terms of the grid is outside the map, ignore it
-			else
-			{
-				horizontalIntersectionsDistance = FLT_MAX;
-			}
-
-			// Until a wall has been found and a distance can be calculated...
-			while (horizontalIntersectionsDistance < 0.0f)
-			{
-				// Find next intersection with a horizontal grid line
-				aX += dx;
-				aY += dy;
-
-				// Convert back to grid coordinates
-				aXgrid = static_cast<int>(aX / gridSize);
-				aYgrid = static_cast<int>(aY / gridSize);
-
-				// Find the distance
-				if (!(aXgrid < 0 || aXgrid >= gridWidth))
-				{
-					if (gridMap[aYgrid * gridWidth + aXgrid] == '#')
-					{
-						horizontalIntersectionsDistance = sqrtf((playerX - aX) * (playerX - aX) + (playerY - aY) * (playerY - aY));;
-					}
-				}
-				else
-				{
-					horizontalIntersectionsDistance = FLT_MAX;
-				}
-			}
-
-			// Once the intersection point has been found, save it for debugging purposes
-			if(DEBUG)
-				aPoints[x] = point{ aX, aY };
-
-			// CALCULATE VERTICAL INTERSECTIONS (very similar to calculating horizontal intersections)
-			float verticalIntersectionsDistance{ -1.0f };
-
-			// Point B is the point of the first intersection between the ray and the vertical grid lines
-			float bX{};
-			float bY{};
-
-			// Reset dx and dy
-			dx = 0.0f;
-			dy = 0.0f;
-
-			// If the ray is facing to the right...
-			if (rayAngle < 90.0f || rayAngle > 270.0f)
-			{
-				// The ray is facing to the right, so it will hit the left wall
-				leftOrRight = true;
-
-				// The first intersection will be in a grid to the right of the current grid
-				bX = floorf(playerX / gridSize) * gridSize + gridSize;
-
-				// The ray is moving in a positive x-direction
-				dx = static_cast<float>(gridSize);
-
-				//	      90					90		
-				//  -x,-y | +x,-y			-tan | +tan
-				// 180 ---+--- 0		  180 ---+--- 0	
-				//	-x,+y |	+x,+y			+tan | -tan
-				//		 270				    270		
-				// When rayAngle < 180, dy should be <0, and when rayAngle > 180, dy should be >0
-				// It just so happens that tan is >0 when rayAngle < 180 degrees, and tan is <0 when rayAngle > 180
-				// so I have to flip the signs with the negative
-				dy = -tanOfRayAngle * gridSize;
-
-				// Calculate the y-coordinate of the first intersection with a vertical gridline
-				bY = playerY + (playerX - bX) * tanOfRayAngle;
-			}
-			// If the ray is facing to the left...
-			else
-			{
-				// The ray is facing left so it will hit the wall to the right
-				leftOrRight = false;
-
-				// The first intersection will be in a grid to the left
-				bX = floorf(playerX / gridSize) * gridSize;
-
-				// The ray is moving in a negative x-direction
-				dx = -static_cast<float>(gridSize);
-
-				//	      90					90		
-				//  -x,-y | +x,-y			-tan | +tan
-				// 180 ---+--- 0		  180 ---+--- 0	
-				//	-x,+y |	+x,+y			+tan | -tan
-				//		 270				    270		
-				// When rayAngle < 180, dy should be <0, and when rayAngle > 180, dy should be >0
-				// It just so happens that tan is <0 when rayAngle < 180 degrees, and tan is >0 when rayAngle > 180
-				// so I don't have to change the signs at all
-				dy = tanOfRayAngle * gridSize;
-
-				// Calculate the y-coordinate of the first intersection with a vertical gridline
-				bY = playerY + (playerX - bX) * tanOfRayAngle;
-
-				bX--;
-			}
-
-			// Same process as with the horizontal intersection code
-			int bXgrid{ static_cast<int>(bX / gridSize) };
-			int bYgrid{ static_cast<int>(bY / gridSize) };
-
-			if (!(bYgrid < 0 || bYgrid >= gridHeight))
-			{
-				if (gridMap[bYgrid * gridWidth + bXgrid] == '#')
-				{
-					verticalIntersectionsDistance = sqrtf((playerX - bX) * (playerX - bX) + (playerY - bY) * (playerY - bY));
-				}
-			}
-			else
-			{
-				verticalIntersectionsDistance = FLT_MAX;
-			}
-
-			while (verticalIntersectionsDistance < 0.0f)
-			{
-				bX += dx;
-				bY += dy;
-
-				bXgrid = static_cast<int>(bX / gridSize);
-				bYgrid = static_cast<int>(bY / gridSize);
-
-				if (!(bYgrid < 0 || bYgrid >= gridHeight))
-				{
-					if (gridMap[bYgrid * gridWidth + bXgrid] == '#')
-					{
-						verticalIntersectionsDistance = sqrtf((playerX - bX) * (playerX - bX) + (playerY - bY) * (playerY - bY));
-					}
-				}
-				else
-				{
-					verticalIntersectionsDistance = FLT_MAX;
-				}
-			}
-
-			// Again, once the intersection point has been found, save it for debugging purposes
-			if(DEBUG)
-				bPoints[x] = point{ bX, bY };
-
-			// The column the ray hits on a wall
-			int gridSpaceColumn{};
-
-			// The ray used for rendering is the shorter one, so save the one which is a smaller distance away to the actual intersection
-			// points vector
-			if (horizontalIntersectionsDistance < verticalIntersectionsDistance)
-			{
-				if(DEBUG)
-					actualPoints[x] = aPoints[x];
-
-				// x-coordinate of intersection with wall
-				int intersectionX{ static_cast<int>(aX) };
-
-				// If the ray hit the top of a wall...
-				if (topOrBottom)
-				{
-					// First column on the top of the wall; at the top left corner of the wall
-					int gridX{ static_cast<int>(static_cast<float>(intersectionX) / gridSize) * gridSize + (gridSize - 1) };
-					gridSpaceColumn = gridX - intersectionX;
-				}
-				// If the ray hit the bottom of a wall...
-				else
-				{
-					// First column on the bottom of the wall; at the bottom right corner of the wall
-					int gridX{ static_cast<int>(static_cast<float>(intersectionX) / gridSize) * gridSize };
-					gridSpaceColumn = intersectionX - gridX;
-				}
-			}
-			else
-			{
-				if(DEBUG)
-					actualPoints[x] = bPoints[x];
-
-				// y-coordinate of intersection with the wall
-				int intersectionY{ static_cast<int>(bY) };
-
-				// If the ray hit the left side of the wall...
-				if (leftOrRight)
-				{
-					// First column on the left side of the wall; at the top left corner of the wall
-					int gridY{ static_cast<int>(static_cast<float>(intersectionY) / gridSize) * gridSize };
-					gridSpaceColumn = intersectionY - gridY;
-				}
-				else
-				{
-					// First column on the right side of the wall; at the bottom right corner of the wall
-					int gridY{ static_cast<int>(static_cast<float>(intersectionY) / gridSize) * gridSize + (gridSize - 1) };
-					gridSpaceColumn = gridY - intersectionY;
-				}
-			}
-
-			// Determine the smaller distance
-			float distance{ std::min(horizontalIntersectionsDistance, verticalIntersectionsDistance) };
-
-			// Calculate the lighting each wall sliver experiences, if the player were a light
-			float lighting = -0.4 * distance + 255;
-
-			// If the light level is less than 0, clamp to zero
-			if (lighting < 0)
-				lighting = 0;
-
-			// Correct fish-eye distortion for the actual rendering of the walls
-			distance *= cosf(radians(theta - rayAngle));
-
-			// Calculate the height of the wall
-			int wallHeight{ static_cast<int>((distanceToProjectionPlane * gridSize) / distance) };
-			int halfWallHeight{ static_cast<int>(wallHeight / 2.0f) };
-
-			// Y-coordinates of the bottom and top of the wall. Calculated in terms of player height and projection plane center (using similar
-			// triangles) so that when the player height changes, the location of the wall will as well
-			int bottomOfWall{ static_cast<int>(projectionPlaneCenter + (distanceToProjectionPlane * playerHeight) / distance) };
-			int topOfWall{ bottomOfWall - wallHeight };
-
-			// Calculate the gap between the top of the wall and the top of the screen; this is used for drawing the wall sliver
-			// int ceilingGap{ static_cast<int>((height - wallHeight) / 2) };
-			
-			// The column on the texture which corresponds to the position of the ray intersection with the wall
-			int textureSpaceColumn{ static_cast<int>(static_cast<float>(gridSpaceColumn) / gridSize * wallTexture.m_width) };
-
-			// If I put std::min(bottomOfWall, height) into the for loop, it would evaluate every iteration, which is wasteful
-			// because the value doesn't change
-			int minBetweenHeightAndBottomOfWall{ std::min(bottomOfWall, height) };
-
-			// Draw the wall sliver
-			for (int y{ std::max(topOfWall, 0) }; y < minBetweenHeightAndBottomOfWall; y++)
-			{
-				// The row on the texture
-				int textureSpaceRow{ static_cast<int>((y - topOfWall) / static_cast<float>(wallHeight) * wallTexture.m_height) };
-
-				// Get the color of the texture at the point on the wall (x, y)
-				uint32_t color{ wallTexture[textureSpaceRow * wallTexture.m_width + textureSpaceColumn] };
-
-				screen[y * width + x] = calculateLighting(color, lighting);
-			}
-
-			// Precalculate some values that will be used in the for loop below
-			float cosOfRayAngle{ cosf(radians(rayAngle)) };
-			float sinOfRayAngle{ sinf(radians(rayAngle)) };
-			float cosOfThetaMinusRayAngle{ cosf(radians(theta - rayAngle)) };
-
-			// Floor cast
-			// y is a point on the projection plane from the bottom of the wall to the end of the screen
-			for (int y{ bottomOfWall }; y < height; y++)
-			{
-				// The straight, vertical line distance to the point on the floor
-				float straightDistance{ static_cast<float>(playerHeight * distanceToProjectionPlane) / (y - projectionPlaneCenter) };
-
-				// The corrected distance to the point on the floor (reverse fisheye)
-				float correctedDistance{ straightDistance / cosOfThetaMinusRayAngle };
-
-				// x and y components of a vector with a length of correctedDistance and angle of rayAngle
-				float dx{ correctedDistance * cosOfRayAngle };
-				float dy{ correctedDistance * -sinOfRayAngle };
-
-				// Calculate the location on the floor of the map of the current point
-				float pX{ playerX + dx };
-				float pY{ playerY + dy };
-
-				// Check if the point is outside the map. Happens when the player's height is very small
-				if (pX < 0.0f || pX >= gridWidth * gridSize || pY < 0.0f || pY >= gridHeight * gridSize)
-					continue;
-
-				if (DEBUG)
-					floorPoints.push_back(point{ pX, pY });
-
-				// Calculate the pixel coordinates of the grid square point P is in
-				int gridPX{ static_cast<int>(pX / gridSize) * gridSize };
-				int gridPY{ static_cast<int>(pY / gridSize) * gridSize };
-
-				// Find the coordinates of point P within the grid square and normalize them
-				float normX{ (static_cast<int>(pX) - gridPX) / static_cast<float>(gridSize) };
-				float normY{ (static_cast<int>(pY) - gridPY) / static_cast<float>(gridSize) };
-
-				// Calculate the coordinates of point P in texture space
-				int textureX{ static_cast<int>(normX * floorTexture.m_width) };
-				int textureY{ static_cast<int>(normY * floorTexture.m_height) };
-
-				int i{ textureY * floorTexture.m_width + textureX };
-
-				if (i < 0)
-					std::cout << "Column: " << x << ", Row: " << y << '\n';
-
-				// Calculate the lighting at that point on the floor
-				float lighting{ -0.4f * correctedDistance + 255.0f };
-				
-				if (lighting < 0.0f)
-					lighting = 0.0f;
-
-				screen[y * width + x] = calculateLighting(floorTexture[textureY * floorTexture.m_width + textureX], lighting);
-			}
+			lightmap.clearDynamicLights();
+			lightmap.addDynamicLight(Light{ playerX, playerY, static_cast<float>(playerHeight), 256.0f, WHITE, 0.5f });
+		}
 
-			// Ceiling casting. Basically the same process as floorcasting, except from the top of the wall up
-			for (int y{ topOfWall }; y > 0; y--)
-			{
-				// The straight, vertical line distance to the point on the ceiling
-				float straightDistance{ static_cast<float>((gridSize - playerHeight) * distanceToProjectionPlane) / (projectionPlaneCenter - y) };
+		// The camera is drawn between the last two steps of the collision world, the way far into the next step this frame is.
+		// Using playerX and playerY straight would make it judder, since the steps don't line up with the frames
+		float cameraX{ collisionWorld.interpolatedX(collisionWorld.bodies[0]) };
+		float cameraY{ collisionWorld.interpolatedY(collisionWorld.bodies[0]) };
 
-				// The corrected distance to the point on the ceiling (Reverse fish eye)
-				float correctedDistance{ straightDistance / cosOfThetaMinusRayAngle };
+		// Give the kernel this frame's camera
+		renderContext.camera = Camera{ cameraX, cameraY, theta, playerHeight, projectionPlaneCenter };
 
-				// x and y components of a vector with a length of correctedDistance and angle of rayAngle
-				float dx{ correctedDistance * cosOfRayAngle };
-				float dy{ correctedDistance * -sinOfRayAngle };
+		Uint64 renderStart{ SDL_GetPerformanceCounter() };
 
-				// Calculate the location on the ceiling of the map of the current point
-				float pX{ playerX + dx };
-				float pY{ playerY + dy };
+		// The rear view looks the opposite way from the same spot
+		if (rearView)
+		{
+			View& view{ views->view(rearViewIndex) };
+			view.camera = Camera{ cameraX, cameraY, theta + 180.0f, playerHeight, view.height / 2 };
+		}
 
-				// Check if the point is outside of the map. Happens when the player's height is large
-				if (pX < 0.0f || pX >= gridWidth * gridSize || pY < 0.0f || pY >= gridHeight * gridSize)
-					continue;
+		// Send a ray out into the scene for each vertical row of pixels in the screen array
+		if (temporalReprojection)
+			reprojector.render(renderContext);
+		else if (mainViewIndex < 0)
+			renderColumns(renderContext, 0, width);
 
-				// Calculate the pixel coordinates of the grid square point P is in
-				int gridPX{ static_cast<int>(pX / gridSize) * gridSize };
-				int gridPY{ static_cast<int>(pY / gridSize) * gridSize };
+		// Then the views, drawn on top of the main one or along with it
+		if (views)
+		{
+			if (mainViewIndex >= 0)
+				views->view(mainViewIndex).camera = renderContext.camera;
 
-				// Find the coordinates of point P within the grid square and normalize them
-				float normX{ (static_cast<int>(pX) - gridPX) / static_cast<float>(gridSize) };
-				float normY{ (static_cast<int>(pY) - gridPY) / static_cast<float>(gridSize) };
+			views->render(screen, width);
+		}
 
-				// Calculate the coordinates of point P in texture space
-				int textureX{ static_cast<int>(normX * ceilingTexture.m_width) };
-				int textureY{ static_cast<int>(normY * ceilingTexture.m_height) };
+		// Rays stop at the fog, so a shorter view distance means fewer steps per ray and fewer floor and ceiling pixels to texture.
+		// Pull the fog in a bit when the frame took too long, and let it back out slowly when there is time to spare, up to the
+		// view distance that was asked for. It never comes closer than a few blocks
+		if (adaptiveViewDistance && viewDistance > 0.0f)
+		{
+			float renderTime{ static_cast<float>(SDL_GetPerformanceCounter() - renderStart) / SDL_GetPerformanceFrequency() };
+			float previousViewDistance{ renderContext.viewDistance };
 
-				// Calculate the lighting at that point on the ceiling
-				float lighting{ -0.4f * correctedDistance + 255.0f };
+			if (renderTime > renderBudget)
+				renderContext.viewDistance = std::max(renderContext.viewDistance * 0.95f, std::min(gridSize * 4.0f, viewDistance));
+			else if (renderTime < renderBudget * 0.8f)
+				renderContext.viewDistance = std::min(renderContext.viewDistance * 1.02f, viewDistance);
 
-				if (lighting < 0.0f)
-					lighting = 0.0f;
+			renderContext.fogStart = renderContext.viewDistance * 0.5f;
 
-				screen[y * width + x] = calculateLighting(ceilingTexture[textureY * ceilingTexture.m_width + textureX], lighting);
-			}
+			// The reused columns would be from a different amount of fog
+			if (renderContext.viewDistance != previousViewDistance)
+				reprojector.invalidate();
 		}
 
+		// Hand a copy of the finished frame to the writer thread
+		if (frameCapture)
+			frameCapture->capture(screen, width);
+
 		// Update the texture that will be drawn to the screen with the array of pixels
 		SDL_UpdateTexture(frameBuffer, NULL, screen, width * sizeof(uint32_t));
 
@@ -825,70 +732,12 @@ int main(int argc, char* argv[])
 
 		if (DEBUG)
 		{
-			// Draw a the map to the right
-			SDL_SetRenderDrawColor(renderTarget, 255, 255, 255, 255);
-			for (int x{ 0 }; x < gridWidth; x++)
-			{
-				for (int y{ 0 }; y < gridHeight; y++)
-				{
-					if (gridMap[y * gridWidth + x] == '#')
-					{
-						SDL_Rect r{ x * (height / gridWidth) + width, y * (height / gridHeight), height / gridWidth, height / gridHeight };
-						SDL_RenderDrawRect(renderTarget, &r);
-					}
-				}
-			}
-
-			// Calculate the position of the player from a 640 x 640 grid of pixels to a 400 x 400 grid of pixels
-			float normX{ playerX / (gridSize * gridWidth) * height + width };
-			float normY{ playerY / (gridSize * gridHeight) * height };
-
-			// Draw the player
-			SDL_FRect player{ normX - 5.0f, normY - 5.0f, 10, 10 };
-			SDL_RenderDrawRectF(renderTarget, &player);
-
-			// Draw direction the player is looking
-			SDL_RenderDrawLineF(renderTarget, normX, normY, normX + xSpeed * 1.0f, normY + ySpeed * 1.0f);
+			// Draw the map, the rays and the player to the right, all in one texture
+			overheadView->draw(renderContext.camera, static_cast<float>(FOV), debugCapture, xSpeed, ySpeed);
+			SDL_UpdateTexture(overheadBuffer, NULL, overheadView->pixels(), overheadView->size() * sizeof(uint32_t));
 
-			// Draw the horizontal intersecting rays
-			SDL_SetRenderDrawColor(renderTarget, 255, 255, 255, 0);
-			for (int i{ 0 }; i < aPoints.size(); i++)
-			{
-				float normPointX{ aPoints[i].x / (gridSize * gridWidth) * height + width };
-				float normPointY{ aPoints[i].y / (gridSize * gridHeight) * height };
-				SDL_RenderDrawLineF(renderTarget, normX, normY, normPointX, normPointY);
-			}
-
-			// Draw the vertically intersection rays
-			for (int i{ 0 }; i < bPoints.size(); i++)
-			{
-				float normPointX{ bPoints[i].x / (gridSize * gridWidth) * height + width };
-				float normPointY{ bPoints[i].y / (gridSize * gridHeight) * height };
-				SDL_RenderDrawLineF(renderTarget, normX, normY, normPointX, normPointY);
-			}
-
-			// Draw the rays which are used to render the scene
-			SDL_SetRenderDrawColor(renderTarget, 255, 0, 0, 0);
-			for (int i{ 0 }; i < actualPoints.size(); i++)
-			{
-				float normPointX{ actualPoints[i].x / (gridSize * gridWidth) * height + width };
-				float normPointY{ actualPoints[i].y / (gridSize * gridHeight) * height };
-				SDL_RenderDrawLineF(renderTarget, normX, normY, normPointX, normPointY);
-			}
-
-			// Draws the points from the map which are used for floor casting. Very slow!
-			/*SDL_SetRenderDrawColor(renderTarget, 255, 0, 0, 0);
-			for (int i{ 0 }; i < floorPoints.size(); i++)
-			{
-				float normPointX{ floorPoints[i].x / (gridSize * gridWidth) * height + width };
-				float normPointY{ floorPoints[i].y / (gridSize * gridHeight) * height };
-				SDL_RenderDrawLineF(renderTarget, normX, normY, normPointX, normPointY);
-			}*/
-
-			// Draw FOV
-			SDL_SetRenderDrawColor(renderTarget, 0, 255, 0, 255);
-			SDL_RenderDrawLineF(renderTarget, normX, normY, normX + (100 * cos(radians(theta - FOV / 2.0f))), normY - (100 * sin(radians(theta - FOV / 2.0f))));
-			SDL_RenderDrawLineF(renderTarget, normX, normY, normX + (100 * cos(radians(theta + FOV / 2.0f))), normY - (100 * sin(radians(theta + FOV / 2.0f))));
+			SDL_Rect overheadRect{ width, 0, height, height };
+			SDL_RenderCopy(renderTarget, overheadBuffer, NULL, &overheadRect);
 		}
 
 		// Copy the rendered scene to the screen
@@ -900,16 +749,14 @@ int main(int argc, char* argv[])
 	}
 
 
+	// Finish writing the recording, if there is one
+	stopRecording();
+
 	SDL_DestroyWindow(win);				// Deallocates window memory + winSurface
 	SDL_DestroyRenderer(renderTarget);	// Deallocates the renderer
 	SDL_DestroyTexture(frameBuffer);
+	if (overheadBuffer)
+		SDL_DestroyTexture(overheadBuffer);
 
-	SDL_Quit();
-	IMG_Quit();
-	TTF_Quit();
-	Mix_Quit();
-
-	delete[] screen;
-
-	return 0;
+	return shutDown(screen, 0);
 }
\ No newline at end of file